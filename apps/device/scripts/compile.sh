@@ -15,9 +15,17 @@ echo "Project root: $PROJECT_ROOT"
 
 cd "$PROJECT_ROOT"
 
+# --bench builds the benchmark firmware (bench.h) instead of the normal one
+EXTRA_ARGS=()
+if [ "$1" = "--bench" ]; then
+  echo "Building benchmarks (NAMI_BENCH)"
+  EXTRA_ARGS=(--build-property "compiler.cpp.extra_flags=-DNAMI_BENCH")
+fi
+
 arduino-cli compile \
   --config-file arduino-cli.yaml \
   --fqbn esp32:esp32:esp32 \
+  "${EXTRA_ARGS[@]}" \
   "$PROJECT_ROOT/src/nami"
 
 echo "Compilation completed successfully!"
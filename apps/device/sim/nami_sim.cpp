@@ -0,0 +1,120 @@
+/**
+ * Host build of the Nami firmware
+ *
+ * Compiles the sketch unchanged against the stand-ins in stubs/: FreeRTOS
+ * tasks become threads, Wire feeds a simulated SSD1306, WiFi is up unless
+ * an outage is simulated, and WebSocketsClient/AsyncTCP use real sockets,
+ * so the device talks to a local server (see apps/server/src/sim/stubServer.ts).
+ *
+ * Usage: nami_sim [--frames DIR] [--seconds N] [--wifi-blip N]
+ *   --frames DIR   write every distinct screen as DIR/frame_NNNNN.pbm
+ *   --seconds N    exit after N seconds (default: run until killed)
+ *   --wifi-blip N  drop WiFi for SIM_WIFI_BLIP_MS every N seconds
+ *
+ * Built with NAMI_BENCH (the nami_bench target) it runs bench.h once and
+ * exits instead.
+ */
+
+#include <Arduino.h>
+#include "nami.ino"
+#include "sim_panel.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#define SIM_FRAME_POLL_MS 5
+#define SIM_WIFI_BLIP_MS 2000
+
+#ifdef NAMI_BENCH
+int main() {
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+  Serial.begin(115200);
+  Wire.begin(21, 22);
+  display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
+  runBenchmarks(display);
+  fflush(stdout);
+  _exit(0);
+}
+#else
+
+/**
+ * Arduino's loop task: setup() once, then loop() until the sketch deletes
+ * the task (vTaskDelete(NULL) parks the thread)
+ */
+static void loopTask() {
+  setup();
+  for (;;) {
+    loop();
+    yield();
+  }
+}
+
+/**
+ * Writes the panel as a numbered PBM whenever its content changed
+ * @param dir Output directory
+ * @param lastVersion Panel version already written
+ * @param index Number of the next image
+ */
+static void dumpFrame(const std::string& dir, uint32_t& lastVersion, uint32_t& index) {
+  uint32_t version = simPanel.version();
+  if (version == lastVersion) {
+    return;
+  }
+  lastVersion = version;
+
+  char path[512];
+  snprintf(path, sizeof(path), "%s/frame_%05u.pbm", dir.c_str(), index++);
+  if (!simPanel.writePbm(path)) {
+    fprintf(stderr, "[Sim] Cannot write %s\n", path);
+  }
+}
+
+int main(int argc, char** argv) {
+  std::string framesDir;
+  double seconds = 0;
+  double blipEvery = 0;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--frames" && i + 1 < argc) {
+      framesDir = argv[++i];
+    } else if (arg == "--seconds" && i + 1 < argc) {
+      seconds = atof(argv[++i]);
+    } else if (arg == "--wifi-blip" && i + 1 < argc) {
+      blipEvery = atof(argv[++i]);
+    } else {
+      fprintf(stderr, "Usage: %s [--frames DIR] [--seconds N] [--wifi-blip N]\n", argv[0]);
+      return 2;
+    }
+  }
+  setvbuf(stdout, nullptr, _IOLBF, 0);
+
+  std::thread(loopTask).detach();
+
+  auto start = std::chrono::steady_clock::now();
+  uint32_t lastVersion = 0;
+  uint32_t index = 0;
+  double nextBlip = blipEvery;
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(SIM_FRAME_POLL_MS));
+    if (!framesDir.empty()) {
+      dumpFrame(framesDir, lastVersion, index);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (blipEvery > 0 && elapsed.count() >= nextBlip) {
+      printf("[Sim] WiFi outage for %d ms\n", SIM_WIFI_BLIP_MS);
+      simWiFiOutage(SIM_WIFI_BLIP_MS);
+      nextBlip += blipEvery;
+    }
+    if (seconds > 0 && elapsed.count() >= seconds) {
+      break;
+    }
+  }
+
+  // The firmware threads never return; leave without running destructors
+  // under their feet
+  fflush(stdout);
+  _exit(0);
+}
+#endif // NAMI_BENCH
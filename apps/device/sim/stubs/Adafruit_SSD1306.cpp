@@ -0,0 +1,149 @@
+#include "Adafruit_SSD1306.h"
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire* twi, int8_t rst_pin,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+  : Adafruit_GFX(w, h), wire(twi), buffer(nullptr), i2caddr(0), vccstate(0),
+    page_end(0), wireClk(clkDuring), restoreClk(clkAfter) {
+  (void)rst_pin;
+}
+
+Adafruit_SSD1306::~Adafruit_SSD1306() {
+  free(buffer);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t switchvcc, uint8_t addr, bool reset, bool periphBegin) {
+  (void)reset;
+  if (!buffer && !(buffer = (uint8_t*)malloc(WIDTH * ((HEIGHT + 7) / 8)))) {
+    return false;
+  }
+  clearDisplay();
+  vccstate = switchvcc;
+  i2caddr = addr ? addr : ((HEIGHT == 32) ? 0x3C : 0x3D);
+  page_end = (HEIGHT + 7) / 8 - 1;
+  if (periphBegin) {
+    wire->begin();
+  }
+
+  static const uint8_t init[] = {
+    SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+    SSD1306_SETMULTIPLEX, 0x3F, SSD1306_SETDISPLAYOFFSET, 0x00,
+    SSD1306_SETSTARTLINE | 0x00, SSD1306_CHARGEPUMP, 0x14,
+    SSD1306_MEMORYMODE, 0x00, SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC,
+    SSD1306_SETCOMPINS, 0x12, SSD1306_SETCONTRAST, 0xCF,
+    SSD1306_SETPRECHARGE, 0xF1, SSD1306_SETVCOMDETECT, 0x40,
+    SSD1306_DISPLAYALLON_RESUME, SSD1306_NORMALDISPLAY,
+    SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON,
+  };
+  ssd1306_commandList(init, sizeof(init));
+  return true;
+}
+
+void Adafruit_SSD1306::ssd1306_command1(uint8_t c) {
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  wire->write(c);
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_commandList(const uint8_t* c, uint8_t n) {
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x00);
+  uint16_t bytesOut = 1;
+  while (n--) {
+    if (bytesOut >= I2C_BUFFER_LENGTH) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x00);
+      bytesOut = 1;
+    }
+    wire->write(*c++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c) {
+  ssd1306_command1(c);
+}
+
+void Adafruit_SSD1306::display(void) {
+  const uint8_t window[] = {SSD1306_PAGEADDR, 0, (uint8_t)page_end, SSD1306_COLUMNADDR, 0, (uint8_t)(WIDTH - 1)};
+  ssd1306_commandList(window, sizeof(window));
+
+  uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
+  uint8_t* ptr = buffer;
+  wire->beginTransmission(i2caddr);
+  wire->write((uint8_t)0x40);
+  uint16_t bytesOut = 1;
+  while (count--) {
+    if (bytesOut >= I2C_BUFFER_LENGTH) {
+      wire->endTransmission();
+      wire->beginTransmission(i2caddr);
+      wire->write((uint8_t)0x40);
+      bytesOut = 1;
+    }
+    wire->write(*ptr++);
+    bytesOut++;
+  }
+  wire->endTransmission();
+}
+
+void Adafruit_SSD1306::clearDisplay(void) {
+  memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i) {
+  ssd1306_command1(i ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
+}
+
+void Adafruit_SSD1306::dim(bool dim) {
+  const uint8_t cmd[] = {SSD1306_SETCONTRAST, (uint8_t)(dim ? 0 : 0xCF)};
+  ssd1306_commandList(cmd, sizeof(cmd));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color) {
+  if (x < 0 || x >= width() || y < 0 || y >= height()) {
+    return;
+  }
+  switch (getRotation()) {
+    case 1: std::swap(x, y); x = WIDTH - x - 1; break;
+    case 2: x = WIDTH - x - 1; y = HEIGHT - y - 1; break;
+    case 3: std::swap(x, y); y = HEIGHT - y - 1; break;
+  }
+  uint8_t& b = buffer[x + (y / 8) * WIDTH];
+  uint8_t bit = 1 << (y & 7);
+  switch (color) {
+    case SSD1306_WHITE: b |= bit; break;
+    case SSD1306_BLACK: b &= ~bit; break;
+    case SSD1306_INVERSE: b ^= bit; break;
+  }
+}
+
+void Adafruit_SSD1306::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+  for (int16_t i = 0; i < w; i++) drawPixel(x + i, y, color);
+}
+
+void Adafruit_SSD1306::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+  for (int16_t i = 0; i < h; i++) drawPixel(x, y + i, color);
+}
+
+void Adafruit_SSD1306::startscrollright(uint8_t start, uint8_t stop) {
+  const uint8_t cmd[] = {SSD1306_RIGHT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF, SSD1306_ACTIVATE_SCROLL};
+  ssd1306_commandList(cmd, sizeof(cmd));
+}
+
+void Adafruit_SSD1306::startscrollleft(uint8_t start, uint8_t stop) {
+  const uint8_t cmd[] = {SSD1306_LEFT_HORIZONTAL_SCROLL, 0x00, start, 0x00, stop, 0x00, 0xFF, SSD1306_ACTIVATE_SCROLL};
+  ssd1306_commandList(cmd, sizeof(cmd));
+}
+
+void Adafruit_SSD1306::stopscroll(void) {
+  ssd1306_command1(SSD1306_DEACTIVATE_SCROLL);
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y) {
+  if (x < 0 || x >= width() || y < 0 || y >= height()) {
+    return false;
+  }
+  return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
@@ -0,0 +1,90 @@
+#include "AsyncTCP.h"
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Error codes passed to onError (lwIP's ERR_CONN)
+#define SIM_TCP_ERR_CONN -11
+
+AsyncClient::~AsyncClient() {
+  close(true);
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+bool AsyncClient::connect(const char* host, uint16_t port) {
+  // The previous connection is over once the firmware starts a new one
+  if (worker.joinable()) {
+    worker.join();
+  }
+  worker = std::thread(&AsyncClient::run, this, std::string(host), port);
+  return true;
+}
+
+void AsyncClient::run(std::string host, uint16_t port) {
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  int sock = -1;
+  if (getaddrinfo(host.c_str(), service, &hints, &addresses) == 0) {
+    for (addrinfo* a = addresses; a != nullptr && sock < 0; a = a->ai_next) {
+      sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+      if (sock >= 0 && ::connect(sock, a->ai_addr, a->ai_addrlen) != 0) {
+        ::close(sock);
+        sock = -1;
+      }
+    }
+    freeaddrinfo(addresses);
+  }
+  if (sock < 0) {
+    if (errorHandler) {
+      errorHandler(errorArg, this, SIM_TCP_ERR_CONN);
+    }
+    return;
+  }
+
+  fd.store(sock);
+  if (connectHandler) {
+    connectHandler(connectArg, this);
+  }
+
+  char chunk[1460];
+  ssize_t got;
+  while ((got = recv(sock, chunk, sizeof(chunk), 0)) > 0) {
+    if (dataHandler) {
+      dataHandler(dataArg, this, chunk, got);
+    }
+  }
+
+  fd.store(-1);
+  ::close(sock);
+  if (disconnectHandler) {
+    disconnectHandler(disconnectArg, this);
+  }
+}
+
+void AsyncClient::close(bool now) {
+  (void)now;
+  int sock = fd.load();
+  if (sock >= 0) {
+    // Wakes the worker's recv(); it closes the socket and reports the disconnect
+    shutdown(sock, SHUT_RDWR);
+  }
+}
+
+size_t AsyncClient::write(const char* data, size_t len) {
+  int sock = fd.load();
+  if (sock < 0) {
+    return 0;
+  }
+  ssize_t n = send(sock, data, len, MSG_NOSIGNAL);
+  return n > 0 ? (size_t)n : 0;
+}
+
+const char* AsyncClient::errorToString(int8_t error) {
+  return error == SIM_TCP_ERR_CONN ? "Connection failed" : "Unknown error";
+}
@@ -0,0 +1,48 @@
+#ifndef SIM_ASYNCTCP_H
+#define SIM_ASYNCTCP_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <thread>
+
+class AsyncClient;
+typedef void (*AcConnectHandler)(void*, AsyncClient*);
+typedef void (*AcDataHandler)(void*, AsyncClient*, void* data, size_t len);
+typedef void (*AcErrorHandler)(void*, AsyncClient*, int8_t error);
+
+/**
+ * Host stand-in for the AsyncTCP client over POSIX sockets
+ * Like the real library, callbacks run on another thread (one worker per
+ * connection here, the async_tcp task on the device), so the firmware's
+ * cross-task handoff is exercised as well.
+ */
+class AsyncClient {
+public:
+  AsyncClient() {}
+  ~AsyncClient();
+  void onConnect(AcConnectHandler cb, void* arg) { connectHandler = cb; connectArg = arg; }
+  void onDisconnect(AcConnectHandler cb, void* arg) { disconnectHandler = cb; disconnectArg = arg; }
+  void onData(AcDataHandler cb, void* arg) { dataHandler = cb; dataArg = arg; }
+  void onError(AcErrorHandler cb, void* arg) { errorHandler = cb; errorArg = arg; }
+  bool connect(const char* host, uint16_t port);
+  void close(bool now = false);
+  size_t write(const char* data, size_t len);
+  const char* errorToString(int8_t error);
+
+private:
+  AcConnectHandler connectHandler = nullptr;
+  void* connectArg = nullptr;
+  AcConnectHandler disconnectHandler = nullptr;
+  void* disconnectArg = nullptr;
+  AcDataHandler dataHandler = nullptr;
+  void* dataArg = nullptr;
+  AcErrorHandler errorHandler = nullptr;
+  void* errorArg = nullptr;
+
+  std::atomic<int> fd{-1};
+  std::thread worker;
+
+  void run(std::string host, uint16_t port);
+};
+
+#endif // SIM_ASYNCTCP_H
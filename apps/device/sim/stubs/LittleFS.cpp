@@ -0,0 +1,26 @@
+#include "LittleFS.h"
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstdlib>
+
+// Files live under $NAMI_SIM_FS (default ./nami_fs)
+static std::string root() {
+  const char* dir = getenv("NAMI_SIM_FS");
+  return dir ? dir : "nami_fs";
+}
+static std::string full(const char* path) { return root() + path; }
+
+size_t File::size() {
+  if (!fp) return 0;
+  long pos = ftell(fp); fseek(fp, 0, SEEK_END); long end = ftell(fp); fseek(fp, pos, SEEK_SET);
+  return (size_t)end;
+}
+bool LittleFSFS::begin(bool) { ::mkdir(root().c_str(), 0755); return true; }
+File LittleFSFS::open(const char* path, const char* mode) {
+  return File(fopen(full(path).c_str(), mode[0] == 'w' ? "wb" : "rb"));
+}
+bool LittleFSFS::exists(const char* path) { struct stat st; return stat(full(path).c_str(), &st) == 0; }
+bool LittleFSFS::remove(const char* path) { return ::unlink(full(path).c_str()) == 0; }
+bool LittleFSFS::mkdir(const char* path) { return ::mkdir(full(path).c_str(), 0755) == 0; }
+LittleFSFS LittleFS;
@@ -0,0 +1,36 @@
+#ifndef SIM_LITTLEFS_H
+#define SIM_LITTLEFS_H
+
+#include <Arduino.h>
+#include <cstdio>
+
+/**
+ * Host stand-in for the ESP32 LittleFS library
+ * Paths map to files under $NAMI_SIM_FS (default ./nami_fs), so the sprite
+ * cache survives restarts of the simulator like it survives reboots.
+ */
+class File {
+public:
+  File(FILE* f = nullptr) : fp(f) {}
+  operator bool() const { return fp != nullptr; }
+  size_t write(const uint8_t* data, size_t len) { return fp ? fwrite(data, 1, len, fp) : 0; }
+  size_t read(uint8_t* data, size_t len) { return fp ? fread(data, 1, len, fp) : 0; }
+  size_t size();
+  void close() { if (fp) fclose(fp); fp = nullptr; }
+
+private:
+  FILE* fp;
+};
+
+class LittleFSFS {
+public:
+  bool begin(bool formatOnFail = false);
+  File open(const char* path, const char* mode);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool mkdir(const char* path);
+};
+
+extern LittleFSFS LittleFS;
+
+#endif // SIM_LITTLEFS_H
@@ -0,0 +1,90 @@
+#include "Preferences.h"
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Every namespace of the simulated NVS partition: "namespace/key" -> bytes
+static std::map<std::string, std::vector<uint8_t>> simNvs;
+static std::mutex simNvsLock;
+
+static std::string nvsKey(const std::string& space, const char* key) {
+  return space + "/" + key;
+}
+
+bool Preferences::begin(const char* name, bool readOnlyMode) {
+  space = name;
+  readOnly = readOnlyMode;
+  open = true;
+  return true;
+}
+
+bool Preferences::clear() {
+  if (!open || readOnly) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  std::string prefix = space + "/";
+  for (auto it = simNvs.begin(); it != simNvs.end();) {
+    it = it->first.compare(0, prefix.size(), prefix) == 0 ? simNvs.erase(it) : std::next(it);
+  }
+  return true;
+}
+
+bool Preferences::remove(const char* key) {
+  if (!open || readOnly) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  return simNvs.erase(nvsKey(space, key)) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  return open && simNvs.count(nvsKey(space, key)) > 0;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  auto it = simNvs.find(nvsKey(space, key));
+  return open && it != simNvs.end() ? it->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buf, size_t maxLen) {
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  auto it = simNvs.find(nvsKey(space, key));
+  if (!open || it == simNvs.end() || it->second.size() > maxLen) {
+    return 0;
+  }
+  memcpy(buf, it->second.data(), it->second.size());
+  return it->second.size();
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t len) {
+  if (!open || readOnly) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> guard(simNvsLock);
+  const uint8_t* bytes = (const uint8_t*)value;
+  simNvs[nvsKey(space, key)].assign(bytes, bytes + len);
+  return len;
+}
+
+bool Preferences::getBool(const char* key, bool defaultValue) {
+  uint8_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value != 0 : defaultValue;
+}
+
+size_t Preferences::putBool(const char* key, bool value) {
+  uint8_t byte = value ? 1 : 0;
+  return putBytes(key, &byte, sizeof(byte));
+}
+
+uint32_t Preferences::getUInt(const char* key, uint32_t defaultValue) {
+  uint32_t value;
+  return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+}
+
+size_t Preferences::putUInt(const char* key, uint32_t value) {
+  return putBytes(key, &value, sizeof(value));
+}
@@ -0,0 +1,31 @@
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+
+/**
+ * Host stand-in for the ESP32 NVS Preferences library
+ * Values live in memory for the lifetime of the process.
+ */
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false);
+  void end() { open = false; }
+  bool clear();
+  bool remove(const char* key);
+  bool isKey(const char* key);
+  bool getBool(const char* key, bool defaultValue = false);
+  size_t putBool(const char* key, bool value);
+  uint32_t getUInt(const char* key, uint32_t defaultValue = 0);
+  size_t putUInt(const char* key, uint32_t value);
+  size_t getBytesLength(const char* key);
+  size_t getBytes(const char* key, void* buf, size_t maxLen);
+  size_t putBytes(const char* key, const void* value, size_t len);
+
+private:
+  std::string space;
+  bool open = false;
+  bool readOnly = false;
+};
+
+#endif // SIM_PREFERENCES_H
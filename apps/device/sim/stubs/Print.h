@@ -0,0 +1,64 @@
+#ifndef SIM_PRINT_H
+#define SIM_PRINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include "WString.h"
+
+#define DEC 10
+#define HEX 16
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size) {
+    size_t n = 0;
+    while (size--) n += write(*buffer++);
+    return n;
+  }
+  size_t write(const char* s) { return s ? write((const uint8_t*)s, strlen(s)) : 0; }
+  size_t write(const char* s, size_t n) { return write((const uint8_t*)s, n); }
+
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str(), s.length()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(int v, int base = DEC) { return printNumber((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return printUnsigned(v, base); }
+  size_t print(long v, int base = DEC) { return printNumber(v, base); }
+  size_t print(unsigned long v, int base = DEC) { return printUnsigned(v, base); }
+  size_t print(long long v, int base = DEC) { return printNumber((long)v, base); }
+  size_t print(unsigned long long v, int base = DEC) { return printUnsigned((unsigned long)v, base); }
+  size_t print(unsigned char v, int base = DEC) { return printUnsigned(v, base); }
+  size_t print(double v, int digits = 2) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", digits, v);
+    return write(buf);
+  }
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T& v, int arg) { size_t n = print(v, arg); return n + println(); }
+  size_t println() { return write("\r\n"); }
+
+private:
+  size_t printNumber(long v, int base) {
+    if (base == DEC) {
+      char buf[24];
+      snprintf(buf, sizeof(buf), "%ld", v);
+      return write(buf);
+    }
+    return printUnsigned((unsigned long)v, base);
+  }
+  size_t printUnsigned(unsigned long v, int base) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), base == HEX ? "%lX" : "%lu", v);
+    return write(buf);
+  }
+};
+
+#endif // SIM_PRINT_H
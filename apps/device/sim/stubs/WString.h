@@ -0,0 +1,89 @@
+#ifndef SIM_WSTRING_H
+#define SIM_WSTRING_H
+
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+
+/**
+ * Arduino String stand-in backed by std::string
+ */
+class String {
+public:
+  String() {}
+  String(const char* s) : value(s ? s : "") {}
+  String(const char* s, size_t n) : value(s, n) {}
+  String(const std::string& s) : value(s) {}
+  String(char c) : value(1, c) {}
+  String(int v) : value(std::to_string(v)) {}
+  String(unsigned int v) : value(std::to_string(v)) {}
+  String(long v) : value(std::to_string(v)) {}
+  String(unsigned long v) : value(std::to_string(v)) {}
+  String(long long v) : value(std::to_string(v)) {}
+  String(unsigned long long v) : value(std::to_string(v)) {}
+  String(double v, unsigned int digits = 2) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)digits, v);
+    value = buf;
+  }
+
+  unsigned int length() const { return value.size(); }
+  const char* c_str() const { return value.c_str(); }
+  char charAt(unsigned int i) const { return i < value.size() ? value[i] : 0; }
+  void setCharAt(unsigned int i, char c) { if (i < value.size()) value[i] = c; }
+  char operator[](unsigned int i) const { return charAt(i); }
+  bool reserve(unsigned int n) { value.reserve(n); return true; }
+
+  String substring(unsigned int from) const { return from < value.size() ? String(value.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    if (from > to) std::swap(from, to);
+    if (from >= value.size()) return String();
+    return String(value.substr(from, to - from));
+  }
+  int indexOf(char c, unsigned int from = 0) const {
+    size_t p = value.find(c, from);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int indexOf(const String& s, unsigned int from = 0) const {
+    size_t p = value.find(s.value, from);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int lastIndexOf(char c) const {
+    size_t p = value.rfind(c);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  int lastIndexOf(char c, unsigned int from) const {
+    size_t p = value.rfind(c, from);
+    return p == std::string::npos ? -1 : (int)p;
+  }
+  void toLowerCase() { for (auto& c : value) c = tolower((unsigned char)c); }
+  void toUpperCase() { for (auto& c : value) c = toupper((unsigned char)c); }
+  void trim() {
+    size_t a = value.find_first_not_of(" \t\r\n");
+    size_t b = value.find_last_not_of(" \t\r\n");
+    value = (a == std::string::npos) ? std::string() : value.substr(a, b - a + 1);
+  }
+  long toInt() const { return atol(value.c_str()); }
+  bool startsWith(const String& s) const { return value.rfind(s.value, 0) == 0; }
+  bool equals(const String& s) const { return value == s.value; }
+
+  String& operator+=(const String& s) { value += s.value; return *this; }
+  String& operator+=(const char* s) { value += s; return *this; }
+  String& operator+=(char c) { value += c; return *this; }
+  String& operator+=(int v) { value += std::to_string(v); return *this; }
+
+  friend String operator+(const String& a, const String& b) { return String(a.value + b.value); }
+  friend String operator+(const String& a, const char* b) { return String(a.value + b); }
+  friend String operator+(const char* a, const String& b) { return String(std::string(a) + b.value); }
+  friend String operator+(const String& a, char b) { return String(a.value + b); }
+  bool operator==(const String& s) const { return value == s.value; }
+  bool operator==(const char* s) const { return value == s; }
+  bool operator!=(const String& s) const { return value != s.value; }
+  bool operator!=(const char* s) const { return value != s; }
+
+private:
+  std::string value;
+};
+
+#endif // SIM_WSTRING_H
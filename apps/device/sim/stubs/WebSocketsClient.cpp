@@ -0,0 +1,306 @@
+#include "WebSocketsClient.h"
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// The accept hash is not checked, so a fixed key will do
+#define SIM_WS_KEY "bmFtaS1zaW11bGF0b3IhIQ=="  // base64 of 16 bytes, as required
+#define SIM_WS_HANDSHAKE_TIMEOUT 2000
+
+int SimTcpClient::available() {
+  int pending = 0;
+  if (sock < 0 || ioctl(sock, FIONREAD, &pending) < 0) {
+    return 0;
+  }
+  return pending;
+}
+
+void WebSocketsClient::begin(const char* hostName, uint16_t portNumber, const char* path, const char* protocol) {
+  (void)protocol;
+  host = hostName;
+  port = portNumber;
+  url = path;
+  started = true;
+  // Like the library: the interval counts from boot until a connect fails
+  _lastConnectionFail = 0;
+}
+
+bool WebSocketsClient::isConnected() {
+  return connected;
+}
+
+void WebSocketsClient::loop() {
+  if (!started) {
+    return;
+  }
+  if (!connected) {
+    if (millis() - _lastConnectionFail < _reconnectInterval) {
+      return;
+    }
+    if (connectSocket() && handshake()) {
+      connected = true;
+      _lastConnectionFail = 0;
+      emit(WStype_CONNECTED, (uint8_t*)url.c_str(), url.length());
+    } else {
+      _lastConnectionFail = millis();
+      closeSocket();
+    }
+    return;
+  }
+  readFrames();
+}
+
+bool WebSocketsClient::connectSocket() {
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  addrinfo hints = {};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* addresses = nullptr;
+  if (getaddrinfo(host.c_str(), service, &hints, &addresses) != 0) {
+    return false;
+  }
+
+  for (addrinfo* a = addresses; a != nullptr; a = a->ai_next) {
+    tcpClient.sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (tcpClient.sock < 0) {
+      continue;
+    }
+    if (connect(tcpClient.sock, a->ai_addr, a->ai_addrlen) == 0) {
+      break;
+    }
+    ::close(tcpClient.sock);
+    tcpClient.sock = -1;
+  }
+  freeaddrinfo(addresses);
+  if (tcpClient.sock < 0) {
+    return false;
+  }
+
+  int one = 1;
+  setsockopt(tcpClient.sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  return true;
+}
+
+bool WebSocketsClient::handshake() {
+  char request[512];
+  int n = snprintf(request, sizeof(request),
+                   "GET %s HTTP/1.1\r\n"
+                   "Host: %s:%u\r\n"
+                   "Connection: Upgrade\r\n"
+                   "Upgrade: websocket\r\n"
+                   "Sec-WebSocket-Version: 13\r\n"
+                   "Sec-WebSocket-Key: " SIM_WS_KEY "\r\n"
+                   "Sec-WebSocket-Protocol: arduino\r\n"
+                   "User-Agent: arduino-WebSocket-Client\r\n"
+                   "\r\n",
+                   url.c_str(), host.c_str(), port);
+  if (send(tcpClient.sock, request, n, MSG_NOSIGNAL) != n) {
+    return false;
+  }
+
+  // Read the response headers; anything after them is already frame data
+  timeval timeout = { SIM_WS_HANDSHAKE_TIMEOUT / 1000, 0 };
+  setsockopt(tcpClient.sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  std::string response;
+  size_t headerEnd = std::string::npos;
+  while (headerEnd == std::string::npos) {
+    char chunk[256];
+    ssize_t got = recv(tcpClient.sock, chunk, sizeof(chunk), 0);
+    if (got <= 0) {
+      return false;
+    }
+    response.append(chunk, got);
+    headerEnd = response.find("\r\n\r\n");
+  }
+  if (response.compare(0, 12, "HTTP/1.1 101") != 0) {
+    Serial.print("[SimWS] Handshake refused: ");
+    Serial.println(response.substr(0, response.find("\r\n")).c_str());
+    return false;
+  }
+
+  received.assign(response.begin() + headerEnd + 4, response.end());
+  fcntl(tcpClient.sock, F_SETFL, fcntl(tcpClient.sock, F_GETFL) | O_NONBLOCK);
+  return true;
+}
+
+void WebSocketsClient::closeSocket() {
+  if (tcpClient.sock >= 0) {
+    ::close(tcpClient.sock);
+    tcpClient.sock = -1;
+  }
+  received.clear();
+}
+
+void WebSocketsClient::disconnect() {
+  if (connected) {
+    sendFrame(0x8, nullptr, 0);
+  }
+  bool wasConnected = connected;
+  connected = false;
+  closeSocket();
+  if (wasConnected) {
+    emit(WStype_DISCONNECTED, nullptr, 0);
+  }
+}
+
+void WebSocketsClient::readFrames() {
+  uint8_t chunk[4096];
+  for (;;) {
+    ssize_t got = recv(tcpClient.sock, chunk, sizeof(chunk), 0);
+    if (got > 0) {
+      received.insert(received.end(), chunk, chunk + got);
+      continue;
+    }
+    if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      break;
+    }
+    // Closed by the server or failed
+    connected = false;
+    closeSocket();
+    emit(WStype_DISCONNECTED, nullptr, 0);
+    return;
+  }
+
+  size_t pos = 0;
+  while (received.size() - pos >= 2) {
+    const uint8_t* header = received.data() + pos;
+    uint8_t opcode = header[0] & 0x0F;
+    bool masked = header[1] & 0x80;
+    uint64_t length = header[1] & 0x7F;
+    size_t headerSize = 2;
+    if (length == 126) {
+      headerSize = 4;
+    } else if (length == 127) {
+      headerSize = 10;
+    }
+    if (masked) {
+      headerSize += 4;
+    }
+    if (received.size() - pos < headerSize) {
+      break;
+    }
+    if (length == 126) {
+      length = (header[2] << 8) | header[3];
+    } else if (length == 127) {
+      length = 0;
+      for (int i = 0; i < 8; i++) {
+        length = (length << 8) | header[2 + i];
+      }
+    }
+    if (received.size() - pos - headerSize < length) {
+      break;
+    }
+
+    // One spare byte so text payloads can be NUL terminated, as the library does
+    std::vector<uint8_t> payload(received.begin() + pos + headerSize,
+                                 received.begin() + pos + headerSize + length);
+    if (masked) {
+      const uint8_t* mask = header + headerSize - 4;
+      for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] ^= mask[i & 3];
+      }
+    }
+    payload.push_back(0);
+    pos += headerSize + length;
+
+    switch (opcode) {
+      case 0x1:
+        emit(WStype_TEXT, payload.data(), length);
+        break;
+      case 0x2:
+        emit(WStype_BIN, payload.data(), length);
+        break;
+      case 0x8:
+        disconnect();
+        return;
+      case 0x9:
+        sendFrame(0xA, payload.data(), length);
+        emit(WStype_PING, payload.data(), length);
+        break;
+      case 0xA:
+        emit(WStype_PONG, payload.data(), length);
+        break;
+      default:
+        Serial.println("[SimWS] Fragmented frame ignored");
+        break;
+    }
+    if (!connected) {
+      return;
+    }
+  }
+  received.erase(received.begin(), received.begin() + pos);
+}
+
+bool WebSocketsClient::sendFrame(uint8_t opcode, const uint8_t* payload, size_t length) {
+  if (tcpClient.sock < 0) {
+    return false;
+  }
+
+  // Client frames are always masked; a zero mask keeps the payload as is
+  std::vector<uint8_t> frame;
+  frame.reserve(length + WEBSOCKETS_MAX_HEADER_SIZE);
+  frame.push_back(0x80 | opcode);
+  if (length < 126) {
+    frame.push_back(0x80 | length);
+  } else if (length <= 0xFFFF) {
+    frame.push_back(0x80 | 126);
+    frame.push_back(length >> 8);
+    frame.push_back(length & 0xFF);
+  } else {
+    frame.push_back(0x80 | 127);
+    for (int i = 7; i >= 0; i--) {
+      frame.push_back((uint64_t)length >> (8 * i));
+    }
+  }
+  frame.insert(frame.end(), 4, 0);
+  frame.insert(frame.end(), payload, payload + length);
+
+  size_t sent = 0;
+  while (sent < frame.size()) {
+    ssize_t n = send(tcpClient.sock, frame.data() + sent, frame.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      usleep(1000);
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += n;
+  }
+  return true;
+}
+
+bool WebSocketsClient::sendTXT(const char* payload, size_t length) {
+  if (!connected) {
+    return false;
+  }
+  if (length == 0) {
+    length = strlen(payload);
+  }
+  return sendFrame(0x1, (const uint8_t*)payload, length);
+}
+
+bool WebSocketsClient::sendTXT(uint8_t* payload, size_t length, bool headerToPayload) {
+  if (!connected) {
+    return false;
+  }
+  // With headerToPayload the text starts after the reserved header room
+  const uint8_t* text = headerToPayload ? payload + WEBSOCKETS_MAX_HEADER_SIZE : payload;
+  return sendFrame(0x1, text, length);
+}
+
+bool WebSocketsClient::sendBIN(const uint8_t* payload, size_t length) {
+  return connected && sendFrame(0x2, payload, length);
+}
+
+void WebSocketsClient::emit(WStype_t type, uint8_t* payload, size_t length) {
+  if (event) {
+    event(type, payload, length);
+  }
+}
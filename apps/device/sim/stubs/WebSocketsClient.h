@@ -0,0 +1,93 @@
+#ifndef SIM_WEBSOCKETSCLIENT_H
+#define SIM_WEBSOCKETSCLIENT_H
+
+#include <Arduino.h>
+#include <functional>
+#include <vector>
+
+// Room the library needs in front of a payload sent with headerToPayload
+#define WEBSOCKETS_MAX_HEADER_SIZE 14
+
+typedef enum {
+  WStype_ERROR,
+  WStype_DISCONNECTED,
+  WStype_CONNECTED,
+  WStype_TEXT,
+  WStype_BIN,
+  WStype_FRAGMENT_TEXT_START,
+  WStype_FRAGMENT_BIN_START,
+  WStype_FRAGMENT,
+  WStype_FRAGMENT_FIN,
+  WStype_PING,
+  WStype_PONG,
+} WStype_t;
+
+/**
+ * Stand-in for the library's WiFiClient: just the socket accessors
+ */
+class SimTcpClient {
+public:
+  int sock = -1;
+  int fd() const { return sock; }
+  uint8_t connected() const { return sock >= 0; }
+  int available();
+};
+
+// Connection state of the library; only the transport is mirrored
+struct WSclient_t {
+  SimTcpClient* tcp;
+};
+
+/**
+ * Host stand-in for the Links2004 WebSocketsClient over POSIX sockets
+ * Same threading model as the library: everything, events included,
+ * happens inside loop() on the calling task. Connects (and reconnects
+ * every reconnect interval) with a blocking handshake, then reads frames
+ * without blocking. Fragmented messages are not supported.
+ */
+class WebSocketsClient {
+public:
+  typedef std::function<void(WStype_t type, uint8_t* payload, size_t length)> WebSocketClientEvent;
+
+  ~WebSocketsClient() { closeSocket(); }
+
+  void begin(const char* host, uint16_t port, const char* url = "/", const char* protocol = "arduino");
+  void onEvent(WebSocketClientEvent cbEvent) { event = cbEvent; }
+  void setReconnectInterval(unsigned long time) { _reconnectInterval = time; }
+  void enableHeartbeat(uint32_t pingInterval, uint32_t pongTimeout, uint8_t disconnectTimeoutCount) {
+    (void)pingInterval; (void)pongTimeout; (void)disconnectTimeoutCount;
+  }
+  void loop();
+  bool isConnected();
+  bool sendTXT(const char* payload, size_t length = 0);
+  bool sendTXT(uint8_t* payload, size_t length, bool headerToPayload);
+  bool sendTXT(const String& payload) { return sendTXT(payload.c_str(), payload.length()); }
+  bool sendBIN(const uint8_t* payload, size_t length);
+  void disconnect();
+
+protected:
+  SimTcpClient tcpClient;
+  WSclient_t _client = { &tcpClient };
+  // Same names and rules as the library: no connect while
+  // millis() - _lastConnectionFail < _reconnectInterval
+  unsigned long _reconnectInterval = 500;
+  unsigned long _lastConnectionFail = 0;
+
+private:
+  WebSocketClientEvent event;
+  String host;
+  uint16_t port = 0;
+  String url;
+  bool connected = false;
+  bool started = false;
+  std::vector<uint8_t> received;
+
+  bool connectSocket();
+  bool handshake();
+  void closeSocket();
+  void readFrames();
+  bool sendFrame(uint8_t opcode, const uint8_t* payload, size_t length);
+  void emit(WStype_t type, uint8_t* payload, size_t length);
+};
+
+#endif // SIM_WEBSOCKETSCLIENT_H
@@ -0,0 +1,113 @@
+#include "WiFi.h"
+
+WiFiClass WiFi;
+
+// The host network is always up: begin() connects at once, except during
+// a simulated outage, after which a pending begin() completes
+static std::recursive_mutex simMutex;
+static wl_status_t simStatus = WL_DISCONNECTED;
+static bool simJoining = false;
+static unsigned long simOutageUntil = 0;
+static WiFiEventCb simEventCallback = nullptr;
+static String simSsid;
+static uint8_t simBssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+static void simEvent(arduino_event_id_t event) {
+  if (simEventCallback) {
+    simEventCallback(event);
+  }
+}
+
+// Completes a pending join once no outage is in the way
+static void simTryJoin() {
+  if (!simJoining || (long)(millis() - simOutageUntil) < 0) {
+    return;
+  }
+  simJoining = false;
+  simStatus = WL_CONNECTED;
+  simEvent(ARDUINO_EVENT_WIFI_STA_CONNECTED);
+  simEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* pass, int32_t channel, const uint8_t* bssid, bool connect) {
+  (void)pass;
+  (void)channel;
+  (void)bssid;
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simSsid = ssid;
+  simStatus = WL_DISCONNECTED;
+  simJoining = connect;
+  simTryJoin();
+  return simStatus;
+}
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap) {
+  (void)wifioff;
+  (void)eraseap;
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  bool wasConnected = simStatus == WL_CONNECTED;
+  simStatus = WL_DISCONNECTED;
+  simJoining = false;
+  if (wasConnected) {
+    simEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+  return true;
+}
+
+bool WiFiClass::reconnect() {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simJoining = true;
+  simTryJoin();
+  return true;
+}
+
+int WiFiClass::onEvent(WiFiEventCb callback) {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simEventCallback = callback;
+  return 1;
+}
+
+void simWiFiOutage(unsigned long duration) {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simOutageUntil = millis() + duration;
+  if (simStatus == WL_CONNECTED) {
+    simStatus = WL_CONNECTION_LOST;
+    simEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  }
+}
+
+bool WiFiClass::config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress dns2) {
+  (void)local; (void)gateway; (void)subnet; (void)dns1; (void)dns2;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  std::lock_guard<std::recursive_mutex> lock(simMutex);
+  simTryJoin();
+  return simStatus;
+}
+
+IPAddress WiFiClass::localIP() {
+  return simStatus == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  return IPAddress(127, 0, 0, 1);
+}
+
+IPAddress WiFiClass::subnetMask() {
+  return IPAddress(255, 0, 0, 0);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t i) {
+  (void)i;
+  return IPAddress(127, 0, 0, 1);
+}
+
+uint8_t* WiFiClass::BSSID() {
+  return simBssid;
+}
+
+String WiFiClass::SSID() {
+  return simSsid;
+}
@@ -0,0 +1,81 @@
+#ifndef SIM_WIFI_H
+#define SIM_WIFI_H
+
+#include <Arduino.h>
+#include <functional>
+#include <mutex>
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+// Station events of the ESP32 core (subset)
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_START = 2,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_WIFI_STA_CONNECTED,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED,
+  ARDUINO_EVENT_WIFI_STA_AUTHMODE_CHANGE,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP6,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP,
+} arduino_event_id_t;
+typedef arduino_event_id_t WiFiEvent_t;
+typedef void (*WiFiEventCb)(arduino_event_id_t event);
+
+class IPAddress {
+public:
+  IPAddress() : addr(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : addr(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  IPAddress(uint32_t a) : addr(a) {}
+  operator uint32_t() const { return addr; }
+  uint8_t operator[](int i) const { return (addr >> (8 * i)) & 0xFF; }
+  String toString() const {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+    return String(buf);
+  }
+private:
+  uint32_t addr;
+};
+
+class WiFiClass {
+public:
+  wl_status_t begin(const char* ssid, const char* pass, int32_t channel = 0, const uint8_t* bssid = nullptr, bool connect = true);
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+  bool reconnect();
+  bool mode(wifi_mode_t m) { (void)m; return true; }
+  bool setSleep(bool enable) { (void)enable; return true; }
+  bool setAutoReconnect(bool enable) { (void)enable; return true; }
+  bool persistent(bool enable) { (void)enable; return true; }
+  bool config(IPAddress local, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(), IPAddress dns2 = IPAddress());
+  wl_status_t status();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t i = 0);
+  int8_t RSSI() { return -55; }
+  uint8_t* BSSID();
+  String BSSIDstr() { return String("02:00:00:00:00:01"); }
+  int32_t channel() { return 6; }
+  String SSID();
+  int onEvent(WiFiEventCb callback);
+};
+
+/**
+ * Simulates an outage: the link drops now and no attempt succeeds for
+ * duration ms (nami_sim --wifi-blip)
+ */
+void simWiFiOutage(unsigned long duration);
+
+extern WiFiClass WiFi;
+
+#endif // SIM_WIFI_H
@@ -0,0 +1,45 @@
+#include "Wire.h"
+#include "sim_panel.h"
+
+TwoWire Wire;
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  (void)sda;
+  (void)scl;
+  if (frequency) {
+    clock = frequency;
+  }
+  return true;
+}
+
+void TwoWire::beginTransmission(uint8_t addr) {
+  address = addr;
+  pending.clear();
+}
+
+size_t TwoWire::write(uint8_t data) {
+  if (pending.size() >= I2C_BUFFER_LENGTH) {
+    return 0;
+  }
+  pending.push_back(data);
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t length) {
+  size_t n = 0;
+  while (n < length && write(data[n])) {
+    n++;
+  }
+  return n;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  // Address byte + payload
+  totalBytes += pending.size() + 1;
+  if (address == 0x3C || address == 0x3D) {
+    simPanel.transmission(pending.data(), pending.size());
+  }
+  pending.clear();
+  return 0;
+}
@@ -0,0 +1,38 @@
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <Arduino.h>
+#include <vector>
+
+#define I2C_BUFFER_LENGTH 128
+
+/**
+ * Host stand-in for the Arduino Wire library
+ * Completed transmissions are handed to the simulated SSD1306 panel.
+ */
+class TwoWire {
+public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  void end() {}
+  void setClock(uint32_t frequency) { clock = frequency; }
+  uint32_t getClock() const { return clock; }
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t data);
+  size_t write(const uint8_t* data, size_t length);
+  uint8_t endTransmission(bool sendStop = true);
+
+  /**
+   * @return total number of bytes put on the bus since start (for benchmarks)
+   */
+  uint64_t busBytes() const { return totalBytes; }
+
+private:
+  uint8_t address = 0;
+  uint32_t clock = 100000;
+  uint64_t totalBytes = 0;
+  std::vector<uint8_t> pending;
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
@@ -0,0 +1,119 @@
+#include "driver/i2c.h"
+#include <Wire.h>
+#include <chrono>
+#include <cstring>
+#include <thread>
+#include "sim_panel.h"
+
+enum SimI2cOpKind : uint8_t { OP_START, OP_WRITE, OP_STOP };
+
+struct SimI2cOp {
+  SimI2cOpKind kind;
+  uint8_t byte;         // OP_WRITE of a single byte (data == nullptr)
+  const uint8_t* data;  // OP_WRITE of a caller buffer, read at cmd_begin time
+  size_t length;
+};
+
+struct SimI2cLink {
+  size_t count;
+  size_t capacity;
+  SimI2cOp ops[1];
+};
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size) {
+  uintptr_t start = ((uintptr_t)buffer + alignof(SimI2cLink) - 1) & ~(uintptr_t)(alignof(SimI2cLink) - 1);
+  size_t usable = size - (start - (uintptr_t)buffer);
+  if (buffer == nullptr || size < (start - (uintptr_t)buffer) + sizeof(SimI2cLink)) {
+    return nullptr;
+  }
+  SimI2cLink* link = (SimI2cLink*)start;
+  link->count = 0;
+  link->capacity = (usable - offsetof(SimI2cLink, ops)) / sizeof(SimI2cOp);
+  return link;
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd) {
+  (void)cmd;
+}
+
+static esp_err_t appendOp(i2c_cmd_handle_t cmd, SimI2cOpKind kind, uint8_t byte, const uint8_t* data, size_t length) {
+  SimI2cLink* link = (SimI2cLink*)cmd;
+  if (link == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (link->count >= link->capacity) {
+    return ESP_ERR_NO_MEM;
+  }
+  link->ops[link->count++] = {kind, byte, data, length};
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+  return appendOp(cmd, OP_START, 0, nullptr, 0);
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en) {
+  (void)ack_en;
+  return appendOp(cmd, OP_WRITE, data, nullptr, 1);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t data_len, bool ack_en) {
+  (void)ack_en;
+  return appendOp(cmd, OP_WRITE, 0, data, data_len);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+  return appendOp(cmd, OP_STOP, 0, nullptr, 0);
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks_to_wait) {
+  (void)ticks_to_wait;
+  SimI2cLink* link = (SimI2cLink*)cmd;
+  if (link == nullptr || port != I2C_NUM_0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // Bytes of the current write, address byte first
+  uint8_t transfer[2048];
+  size_t length = 0;
+  uint64_t bits = 0;
+  auto endTransfer = [&]() {
+    if (length > 1) {
+      uint8_t address = transfer[0] >> 1;
+      if (address == 0x3C || address == 0x3D) {
+        simPanel.transmission(transfer + 1, length - 1);
+      }
+    }
+    length = 0;
+  };
+
+  for (size_t i = 0; i < link->count; i++) {
+    const SimI2cOp& op = link->ops[i];
+    switch (op.kind) {
+      case OP_START:
+        endTransfer();
+        bits += 2;
+        break;
+      case OP_WRITE: {
+        const uint8_t* data = op.data != nullptr ? op.data : &op.byte;
+        size_t n = std::min(op.length, sizeof(transfer) - length);
+        memcpy(transfer + length, data, n);
+        length += n;
+        bits += 9 * op.length;  // 8 data bits and the ack
+        break;
+      }
+      case OP_STOP:
+        endTransfer();
+        bits += 2;
+        break;
+    }
+  }
+  endTransfer();
+
+#ifndef NAMI_BENCH
+  // Host benchmarks leave I2C time out, like the Wire stand-in
+  uint32_t clock = std::max(Wire.getClock(), (uint32_t)1);
+  std::this_thread::sleep_for(std::chrono::microseconds(bits * 1000000 / clock));
+#endif
+  return ESP_OK;
+}
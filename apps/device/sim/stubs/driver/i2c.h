@@ -0,0 +1,39 @@
+#ifndef SIM_DRIVER_I2C_H
+#define SIM_DRIVER_I2C_H
+
+#include <Arduino.h>
+#include "esp_err.h"
+
+/**
+ * Host stand-in for the ESP-IDF (legacy) I2C master driver
+ * Command links are recorded in the caller's buffer, like
+ * i2c_cmd_link_create_static() does, and i2c_master_cmd_begin() hands
+ * every write to the simulated SSD1306 panel. The call takes as long as
+ * the transfer would at the clock set with Wire.setClock() (port 0 is the
+ * Wire bus), so a flush costs bus time as on the device.
+ */
+
+typedef int i2c_port_t;
+#define I2C_NUM_0 0
+#define I2C_NUM_1 1
+
+typedef enum {
+  I2C_MASTER_WRITE = 0,
+  I2C_MASTER_READ,
+} i2c_rw_t;
+
+typedef void* i2c_cmd_handle_t;
+
+#define I2C_INTERNAL_STRUCT_SIZE 24
+#define I2C_LINK_RECOMMENDED_SIZE(TRANSACTIONS) \
+  (2 * I2C_INTERNAL_STRUCT_SIZE + I2C_INTERNAL_STRUCT_SIZE * (5 * (TRANSACTIONS)))
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size);
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t* data, size_t data_len, bool ack_en);
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks_to_wait);
+
+#endif // SIM_DRIVER_I2C_H
@@ -0,0 +1,20 @@
+#ifndef SIM_ESP_VFS_EVENTFD_H
+#define SIM_ESP_VFS_EVENTFD_H
+
+#include <sys/eventfd.h>
+#include "esp_err.h"
+
+// Linux has eventfd natively; registering the VFS driver is a no-op
+
+typedef struct {
+  size_t max_fds;
+} esp_vfs_eventfd_config_t;
+
+#define ESP_VFS_EVENTD_CONFIG_DEFAULT() { 5 }
+
+inline esp_err_t esp_vfs_eventfd_register(const esp_vfs_eventfd_config_t* config) {
+  (void)config;
+  return ESP_OK;
+}
+
+#endif // SIM_ESP_VFS_EVENTFD_H
@@ -0,0 +1,45 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+/**
+ * Counting operator new for the benchmark build (bench.h)
+ * Only nami_bench links this; heap use of the firmware itself goes through
+ * new (String, std::vector, ...) and malloc, of which new is counted.
+ */
+
+static std::atomic<uint64_t> simAllocated(0);
+
+uint64_t hostAllocatedBytes() {
+  return simAllocated.load(std::memory_order_relaxed);
+}
+
+void* operator new(size_t size) {
+  simAllocated.fetch_add(size, std::memory_order_relaxed);
+  void* p = malloc(size ? size : 1);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void* operator new[](size_t size) {
+  return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p) noexcept {
+  free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept {
+  free(p);
+}
@@ -0,0 +1,139 @@
+#include "sim_panel.h"
+#include <cstdio>
+#include <cstring>
+
+SimPanel simPanel;
+
+void SimPanel::reset() {
+  std::lock_guard<std::mutex> guard(lock);
+  memset(gddram, 0, sizeof(gddram));
+  columnStart = 0;
+  columnEnd = WIDTH - 1;
+  pageStart = 0;
+  pageEnd = PAGES - 1;
+  column = page = startLine = 0;
+  inverted = on = false;
+  frames = 0;
+  command = 0;
+  argsExpected = argsSeen = 0;
+  updates++;
+}
+
+void SimPanel::transmission(const uint8_t* data, size_t length) {
+  if (length == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  // First byte is the control byte: 0x00 commands, 0x40 data
+  bool isData = (data[0] & 0x40) != 0;
+  for (size_t i = 1; i < length; i++) {
+    if (isData) {
+      dataByte(data[i]);
+    } else {
+      commandByte(data[i]);
+    }
+  }
+  if (isData) {
+    frames++;
+  }
+  updates.fetch_add(1, std::memory_order_release);
+}
+
+static int argumentCount(uint8_t c) {
+  switch (c) {
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+    case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+      return 1;
+    case 0x21: case 0x22: case 0xA3:
+      return 2;
+    case 0x26: case 0x27:
+      return 6;
+    case 0x29: case 0x2A:
+      return 5;
+    default:
+      return 0;
+  }
+}
+
+void SimPanel::commandByte(uint8_t c) {
+  if (argsExpected > argsSeen) {
+    args[argsSeen++] = c;
+    if (argsSeen == argsExpected) {
+      applyCommand();
+    }
+    return;
+  }
+  command = c;
+  argsSeen = 0;
+  argsExpected = argumentCount(c);
+  if (argsExpected == 0) {
+    applyCommand();
+  }
+}
+
+void SimPanel::applyCommand() {
+  switch (command) {
+    case 0x21:
+      columnStart = args[0] & 0x7F;
+      columnEnd = args[1] & 0x7F;
+      column = columnStart;
+      break;
+    case 0x22:
+      pageStart = args[0] & 0x07;
+      pageEnd = args[1] & 0x07;
+      page = pageStart;
+      break;
+    case 0xA6: inverted = false; break;
+    case 0xA7: inverted = true; break;
+    case 0xAE: on = false; break;
+    case 0xAF: on = true; break;
+    default:
+      if (command >= 0x40 && command <= 0x7F) {
+        startLine = command & 0x3F;
+      }
+      break;
+  }
+  argsExpected = argsSeen = 0;
+}
+
+void SimPanel::dataByte(uint8_t d) {
+  gddram[page * WIDTH + column] = d;
+  // Horizontal addressing mode: advance column, wrap into the next page of the window
+  if (column >= columnEnd) {
+    column = columnStart;
+    page = (page >= pageEnd) ? pageStart : page + 1;
+  } else {
+    column++;
+  }
+}
+
+bool SimPanel::pixel(int x, int y) const {
+  std::lock_guard<std::mutex> guard(lock);
+  return lit(x, y);
+}
+
+bool SimPanel::lit(int x, int y) const {
+  if (x < 0 || x >= WIDTH || y < 0 || y >= HEIGHT) {
+    return false;
+  }
+  int row = (y + startLine) % HEIGHT;
+  bool set = (gddram[(row / 8) * WIDTH + x] >> (row & 7)) & 1;
+  return set != inverted;
+}
+
+bool SimPanel::writePbm(const char* path) const {
+  FILE* f = fopen(path, "w");
+  if (!f) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(lock);
+  fprintf(f, "P1\n%d %d\n", WIDTH, HEIGHT);
+  for (int y = 0; y < HEIGHT; y++) {
+    for (int x = 0; x < WIDTH; x++) {
+      fputc(lit(x, y) ? '1' : '0', f);
+      fputc(x + 1 < WIDTH ? ' ' : '\n', f);
+    }
+  }
+  fclose(f);
+  return true;
+}
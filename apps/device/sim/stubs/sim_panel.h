@@ -0,0 +1,70 @@
+#ifndef SIM_PANEL_H
+#define SIM_PANEL_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+
+/**
+ * Simulated SSD1306 controller
+ * Interprets the I2C command/data stream (address windows, memory mode,
+ * start line, scroll and inversion commands) into a 128x64 GDDRAM, so the
+ * host build exercises the same partial-update paths as the real panel.
+ * The render task writes through Wire while the main thread dumps images,
+ * so every access takes the panel lock.
+ */
+class SimPanel {
+public:
+  static const int WIDTH = 128;
+  static const int HEIGHT = 64;
+  static const int PAGES = HEIGHT / 8;
+
+  void reset();
+  void transmission(const uint8_t* data, size_t length);
+
+  /**
+   * @return true if the pixel is lit as seen on glass (start line applied)
+   */
+  bool pixel(int x, int y) const;
+
+  /**
+   * Writes what the panel currently shows as a plain PBM (P1) image
+   */
+  bool writePbm(const char* path) const;
+
+  uint32_t frameCount() const { return frames; }
+  const uint8_t* ram() const { return gddram; }
+
+  /**
+   * @return counter bumped by every transmission, to detect changes cheaply
+   */
+  uint32_t version() const { return updates.load(std::memory_order_acquire); }
+
+private:
+  mutable std::mutex lock;
+  std::atomic<uint32_t> updates{0};
+  uint8_t gddram[WIDTH * PAGES] = {};
+  int columnStart = 0, columnEnd = WIDTH - 1;
+  int pageStart = 0, pageEnd = PAGES - 1;
+  int column = 0, page = 0;
+  int startLine = 0;
+  bool inverted = false;
+  bool on = false;
+  uint32_t frames = 0;
+
+  // Multi-byte command parser state
+  uint8_t command = 0;
+  int argsExpected = 0;
+  int argsSeen = 0;
+  uint8_t args[8] = {};
+
+  void commandByte(uint8_t c);
+  void applyCommand();
+  void dataByte(uint8_t d);
+  bool lit(int x, int y) const;
+};
+
+extern SimPanel simPanel;
+
+#endif // SIM_PANEL_H
@@ -0,0 +1,152 @@
+#include <Arduino.h>
+#include <chrono>
+#include <thread>
+#include <random>
+
+HardwareSerial Serial;
+EspClass ESP;
+
+static const auto simStart = std::chrono::steady_clock::now();
+static std::mt19937 simRandom(1);
+
+unsigned long millis() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - simStart).count();
+}
+
+unsigned long micros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - simStart).count();
+}
+
+void delay(unsigned long ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+long random(long max) {
+  return max > 0 ? (long)(simRandom() % (unsigned long)max) : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  simRandom.seed(seed);
+}
+
+void yield() {
+  std::this_thread::yield();
+}
+
+void pinMode(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return LOW; }
+void digitalWrite(uint8_t, uint8_t) {}
+void attachInterrupt(uint8_t, void (*)(), int) {}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+uint32_t EspClass::getCycleCount() {
+  // Nanoseconds scaled to a 240 MHz core clock, so numbers read like device cycles
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - simStart).count();
+  return (uint32_t)(ns * 240 / 1000);
+}
+
+uint32_t EspClass::getFreeHeap() { return 200 * 1024; }
+uint32_t EspClass::getMinFreeHeap() { return 200 * 1024; }
+uint32_t EspClass::getMaxAllocHeap() { return 110 * 1024; }
+uint32_t EspClass::getHeapSize() { return 300 * 1024; }
+
+void EspClass::restart() {
+  fflush(stdout);
+  exit(0);
+}
+
+// --- FreeRTOS stand-ins: tasks are std::threads, notifications are counting semaphores ---
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <pthread.h>
+
+struct SimTask {
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t notifications = 0;
+  uint32_t stack = 0;
+};
+static thread_local SimTask* currentTask = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char*, uint32_t stack, void* param,
+                                   unsigned, TaskHandle_t* handle, int) {
+  SimTask* task = new SimTask();
+  task->stack = stack;
+  if (handle) *handle = task;
+  std::thread([fn, param, task]() { currentTask = task; fn(param); }).detach();
+  return pdPASS;
+}
+void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr) {
+    // Deleting the calling task: park it forever (the loop thread ends here)
+    for (;;) std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+}
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+  SimTask* task = (SimTask*)handle;
+  { std::lock_guard<std::mutex> lock(task->mutex); task->notifications++; }
+  task->cv.notify_one();
+  return pdPASS;
+}
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t handle) {
+  // Host threads have no measurable high-water mark; report the stack as unused
+  return handle ? ((SimTask*)handle)->stack : 0;
+}
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  SimTask* task = currentTask;
+  if (!task) { vTaskDelay(ticks == portMAX_DELAY ? 1 : ticks); return 0; }
+  std::unique_lock<std::mutex> lock(task->mutex);
+  auto ready = [task]() { return task->notifications > 0; };
+  if (ticks == portMAX_DELAY) task->cv.wait(lock, ready);
+  else task->cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+  uint32_t value = task->notifications;
+  if (clear) task->notifications = 0; else if (value) task->notifications--;
+  return value;
+}
+
+// Binary semaphores: a flag under a mutex
+struct SimSemaphore {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool given = false;
+};
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return new SimSemaphore();
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t handle) {
+  SimSemaphore* semaphore = (SimSemaphore*)handle;
+  {
+    std::lock_guard<std::mutex> lock(semaphore->mutex);
+    if (semaphore->given) return pdFALSE;
+    semaphore->given = true;
+  }
+  semaphore->cv.notify_one();
+  return pdTRUE;
+}
+BaseType_t xSemaphoreTake(SemaphoreHandle_t handle, TickType_t ticks) {
+  SimSemaphore* semaphore = (SimSemaphore*)handle;
+  std::unique_lock<std::mutex> lock(semaphore->mutex);
+  auto given = [semaphore]() { return semaphore->given; };
+  if (ticks == portMAX_DELAY) semaphore->cv.wait(lock, given);
+  else if (!semaphore->cv.wait_for(lock, std::chrono::milliseconds(ticks), given)) return pdFALSE;
+  semaphore->given = false;
+  return pdTRUE;
+}
@@ -0,0 +1,310 @@
+#ifndef ANIMATION_PLAYER_H
+#define ANIMATION_PLAYER_H
+
+#include <atomic>
+#include "nami_display.h"
+#include "frame_protocol.h"
+#include "render_queue.h"
+#include "pokemon_display.h"
+#include "log.h"
+
+/**
+ * Animated sprite playback
+ *
+ * FRAME_TYPE_ANIMATION frames use the common header (id, width, height,
+ * name, FRAME_FLAG_RLE and FRAME_FLAG_XOR for every frame) followed by:
+ *
+ *   offset  size  field
+ *   0       1     frameCount  (1..ANIMATION_MAX_FRAMES)
+ *   1       2     frameDelay  (ms, little endian)
+ *   3       ...   frameCount x { length (uint16 LE), 1bpp frame data }
+ *
+ * The network task copies the frames into one of two Animation slots and
+ * queues a RENDER_ANIMATION frame; the render task then plays that slot
+ * while the other one is free for the next animation. Only one hand-off can
+ * be in flight, so the slot being written is never the one playing.
+ *
+ * Frames are flipped on an absolute schedule (micros()) from the render
+ * task, which sleeps on its notification until the next frame is due, so
+ * playback never blocks socket handling. Each frame is composed in the
+ * display's back buffer (only the sprite rectangle is redrawn) and then
+ * presented, so only the pages the sprite covers are flushed. Frames that
+ * would start late are dropped rather than slowing the animation down.
+ *
+ * With FRAME_FLAG_XOR, every frame but the first is an XOR patch against
+ * the previous one. Such frames are applied in place and only the 8-row
+ * bands that actually change are flushed; dropped frames are still applied
+ * (composing is cheap, flushing is not) so the chain stays intact.
+ */
+
+#define ANIMATION_CAPACITY (12 * 1024)  // Frame data bytes per slot
+#define ANIMATION_MAX_FRAMES 64
+#define ANIMATION_MIN_FRAME_DELAY 33    // ms, caps playback at ~30 fps
+#define ANIMATION_STATS_INTERVAL 5000   // ms between timing reports
+
+struct Animation {
+  uint16_t id;
+  uint8_t width;
+  uint8_t height;
+  uint8_t flags;
+  char name[32];
+  uint8_t frameCount;
+  uint16_t frameDelay;  // ms
+  uint16_t offsets[ANIMATION_MAX_FRAMES];
+  uint16_t lengths[ANIMATION_MAX_FRAMES];
+  uint8_t data[ANIMATION_CAPACITY];
+};
+
+Animation animationSlots[2];
+
+// Set by the network task when it queues a slot, cleared by the render task once it took it
+std::atomic<bool> animationHandoff(false);
+
+// Next slot the network task fills (network task only)
+uint8_t nextAnimationSlot = 0;
+
+/**
+ * Render path timing, in microseconds
+ */
+struct AnimationStats {
+  uint32_t frames;
+  uint32_t dropped;
+  uint32_t composeTotal;
+  uint32_t flushTotal;
+  uint32_t worstFrame;
+  unsigned long since;
+};
+
+/**
+ * Playback state (render task only)
+ */
+struct AnimationPlayer {
+  const Animation* animation;
+  uint8_t frame;
+  uint32_t nextFrameAt;  // micros()
+  int x;
+  int y;
+  AnimationStats stats;
+};
+
+AnimationPlayer animationPlayer = {nullptr};
+
+/**
+ * Copies an animation frame into a free slot and queues it for playback
+ * Runs on the network task.
+ * @param payload Raw WebSocket binary payload
+ * @param length Payload length in bytes
+ * @return true if the animation was queued
+ */
+bool queueAnimationFrame(const uint8_t* payload, size_t length) {
+  NamiFrame header;
+  if (!decodeFrame(payload, length, header) || header.type != FRAME_TYPE_ANIMATION) {
+    return false;
+  }
+  if (header.width == 0 || header.height == 0 || (header.width + 7) / 8 > RLE_MAX_STRIDE ||
+      header.dataLength < 3) {
+    LOG_WARN("Anim", "Invalid animation header");
+    return false;
+  }
+  if (animationHandoff.load(std::memory_order_acquire)) {
+    LOG_WARN("Anim", "Previous animation not started yet, dropping");
+    return false;
+  }
+
+  const uint8_t* data = header.data;
+  size_t remaining = header.dataLength;
+  uint8_t frameCount = data[0];
+  uint16_t frameDelay = data[1] | (data[2] << 8);
+  data += 3;
+  remaining -= 3;
+  if (frameCount == 0 || frameCount > ANIMATION_MAX_FRAMES) {
+    LOG_WARN("Anim", "Invalid frame count");
+    return false;
+  }
+
+  Animation& animation = animationSlots[nextAnimationSlot];
+  size_t used = 0;
+  size_t rawFrameSize = (size_t)((header.width + 7) / 8) * header.height;
+  for (int i = 0; i < frameCount; i++) {
+    if (remaining < 2) {
+      return false;
+    }
+    uint16_t frameLength = data[0] | (data[1] << 8);
+    data += 2;
+    remaining -= 2;
+    bool tooShort = !(header.flags & FRAME_FLAG_RLE) && frameLength < rawFrameSize;
+    if (frameLength > remaining || used + frameLength > sizeof(animation.data) || tooShort) {
+      LOG_WARN("Anim", "Animation does not fit or is truncated");
+      return false;
+    }
+    memcpy(animation.data + used, data, frameLength);
+    animation.offsets[i] = used;
+    animation.lengths[i] = frameLength;
+    used += frameLength;
+    data += frameLength;
+    remaining -= frameLength;
+  }
+
+  RenderFrame* frame = beginRenderFrame(RENDER_ANIMATION);
+  if (frame == nullptr) {
+    return false;
+  }
+
+  size_t nameLength = min((size_t)header.nameLength, sizeof(animation.name) - 1);
+  memcpy(animation.name, header.name, nameLength);
+  animation.name[nameLength] = '\0';
+  animation.id = header.id;
+  animation.width = header.width;
+  animation.height = header.height;
+  animation.flags = header.flags & (FRAME_FLAG_RLE | FRAME_FLAG_XOR);
+  animation.frameCount = frameCount;
+  animation.frameDelay = max(frameDelay, (uint16_t)ANIMATION_MIN_FRAME_DELAY);
+
+  frame->id = nextAnimationSlot;
+  animationHandoff.store(true, std::memory_order_release);
+  commitRenderFrame();
+  nextAnimationSlot ^= 1;
+
+  LOG_INFO("Anim", "Queued #%u, %u frames @ %u ms, %u bytes", (unsigned)animation.id, (unsigned)frameCount,
+           (unsigned)animation.frameDelay, (unsigned)used);
+  return true;
+}
+
+/**
+ * Draws one animation frame over the previous one, in the back buffer
+ * XOR patches must be applied in order, right after frame index - 1.
+ */
+void composeAnimationFrame(NamiDisplay& display, const Animation& animation, int index, int x, int y) {
+  const uint8_t* data = animation.data + animation.offsets[index];
+  size_t length = animation.lengths[index];
+  uint8_t* buffer = display.getBuffer();
+  bool patch = (animation.flags & FRAME_FLAG_XOR) && index > 0;
+  BlitMode mode = patch ? BLIT_XOR : BLIT_OR;
+
+  if (!patch) {
+    display.fillRect(x, y, animation.width, animation.height, SSD1306_BLACK);
+  }
+  if (animation.flags & FRAME_FLAG_RLE) {
+    uint32_t bands = 0;
+    blitRleBitmap(buffer, display.width(), display.height(), x, y, data, length,
+                  animation.width, animation.height, mode, &bands);
+    markTouchedBands(display, x, y, animation.width, animation.height, bands);
+  } else {
+    blitBitmap(buffer, display.width(), display.height(), x, y, data,
+               animation.width, animation.height, mode);
+    display.markDirty(x, y, animation.width, animation.height);
+  }
+}
+
+/**
+ * Logs and resets the render path timings
+ */
+void reportAnimationStats(AnimationStats& stats, uint16_t frameDelay) {
+  if (stats.frames > 0) {
+    LOG_INFO("Anim", "%.1f fps, compose %u us, flush %u us, worst %u us / budget %u us, dropped %u",
+             stats.frames * 1000.0f / max(millis() - stats.since, 1UL),
+             (unsigned)(stats.composeTotal / stats.frames), (unsigned)(stats.flushTotal / stats.frames),
+             (unsigned)stats.worstFrame, (unsigned)frameDelay * 1000, (unsigned)stats.dropped);
+  }
+  memset(&stats, 0, sizeof(stats));
+  stats.since = millis();
+}
+
+/**
+ * Stops playback (another screen replaced the animation)
+ */
+void stopAnimation() {
+  animationPlayer.animation = nullptr;
+}
+
+/**
+ * Starts playing an animation slot queued by queueAnimationFrame()
+ * Draws the header and the first frame right away.
+ * @param display Reference to the NamiDisplay object
+ * @param slot Slot index from the RENDER_ANIMATION frame
+ */
+void startAnimation(NamiDisplay& display, uint8_t slot) {
+  const Animation& animation = animationSlots[slot & 1];
+  animationHandoff.store(false, std::memory_order_release);
+
+  AnimationPlayer& player = animationPlayer;
+  player.animation = &animation;
+  player.frame = 0;
+  pokemonBitmapOrigin(animation.width, animation.height, player.x, player.y);
+  reportAnimationStats(player.stats, animation.frameDelay);
+
+  // Header and first frame are presented together
+  display.beginFrame();
+  bool shown = displayPokemonBitmap(display, animation.id, animation.name, animation.width,
+                                    animation.height, animation.data, animation.lengths[0],
+                                    animation.flags);
+  display.presentFrame();
+  if (!shown) {
+    // Later frames are XOR patches and would land on the error screen
+    LOG_WARN("Anim", "First frame failed to draw, stopping");
+    stopAnimation();
+    return;
+  }
+
+  player.nextFrameAt = micros() + (uint32_t)animation.frameDelay * 1000;
+}
+
+/**
+ * Shows the next frame if it is due
+ * @param display Reference to the NamiDisplay object
+ * @return milliseconds until the next frame is due, or portMAX_DELAY when
+ *         nothing is playing
+ */
+uint32_t serviceAnimation(NamiDisplay& display) {
+  AnimationPlayer& player = animationPlayer;
+  const Animation* animation = player.animation;
+  if (animation == nullptr) {
+    return portMAX_DELAY;
+  }
+
+  uint32_t now = micros();
+  int32_t wait = (int32_t)(player.nextFrameAt - now);
+  if (wait > 0) {
+    return (wait + 999) / 1000;
+  }
+
+  // Skip frames whose slot has already passed
+  uint32_t period = (uint32_t)animation->frameDelay * 1000;
+  uint32_t late = (uint32_t)(-wait);
+  uint32_t skipped = late / period;
+  player.stats.dropped += skipped;
+  player.nextFrameAt += (skipped + 1) * period;
+
+  uint32_t steps = skipped + 1;
+  uint8_t target = (player.frame + steps) % animation->frameCount;
+  // XOR patches build on each other: replay from the previous frame, or
+  // from the full first frame once the loop wrapped around
+  int first = target;
+  if (animation->flags & FRAME_FLAG_XOR) {
+    first = (steps >= animation->frameCount || target < player.frame) ? 0 : player.frame + 1;
+  }
+
+  uint32_t start = micros();
+  display.beginFrame();
+  for (int i = first; i <= target; i++) {
+    composeAnimationFrame(display, *animation, i, player.x, player.y);
+  }
+  player.frame = target;
+  uint32_t composed = micros();
+  display.presentFrame();
+  uint32_t flushed = micros();
+
+  AnimationStats& stats = player.stats;
+  stats.frames++;
+  stats.composeTotal += composed - start;
+  stats.flushTotal += flushed - composed;
+  stats.worstFrame = max(stats.worstFrame, flushed - start);
+  if (millis() - stats.since >= ANIMATION_STATS_INTERVAL) {
+    reportAnimationStats(stats, animation->frameDelay);
+  }
+
+  int32_t next = (int32_t)(player.nextFrameAt - micros());
+  return next > 0 ? (next + 999) / 1000 : 0;
+}
+
+#endif // ANIMATION_PLAYER_H
@@ -3,7 +3,7 @@
 
 #include <HTTPClient.h>
 #include <ArduinoJson.h>
-#include <Adafruit_SSD1306.h>
+#include "nami_display.h"
 #include "wifi_connection.h"
 
 // PokéAPI base URL
@@ -13,12 +13,12 @@
 
 /**
  * Fetches a random Pokémon from PokéAPI and returns the response as a string
- * @param display Reference to the Adafruit_SSD1306 display object for status updates
+ * @param display Reference to the NamiDisplay object for status updates
  * @return String containing the API response, or empty string on error
  */
-String fetchRandomPokemon(Adafruit_SSD1306& display) {
+String fetchRandomPokemon(NamiDisplay& display) {
   // Check WiFi connection first
-  if (!checkWiFiConnection(display)) {
+  if (!checkWiFiConnection()) {
     return "";
   }
 
@@ -75,11 +75,11 @@ String fetchRandomPokemon(Adafruit_SSD1306& display) {
  * where the sprite would appear.
  * 
  * @param spriteUrl The URL of the sprite image (currently unused, kept for future implementation)
- * @param display Reference to the Adafruit_SSD1306 display object
+ * @param display Reference to the NamiDisplay object
  * @param x X position on display
  * @param y Y position on display
  */
-void displayPokemonSprite(const String& spriteUrl, Adafruit_SSD1306& display, int x, int y) {
+void displayPokemonSprite(const String& spriteUrl, NamiDisplay& display, int x, int y) {
   // Draw a border around sprite area (32x32 pixels)
   display.drawRect(x, y, 32, 32, SSD1306_WHITE);
   
@@ -100,9 +100,9 @@ void displayPokemonSprite(const String& spriteUrl, Adafruit_SSD1306& display, in
 /**
  * Parses Pokémon JSON response and displays name, ID, and sprite info
  * @param jsonString The JSON string to parse
- * @param display Reference to the Adafruit_SSD1306 display object
+ * @param display Reference to the NamiDisplay object
  */
-void displayPokemonData(const String& jsonString, Adafruit_SSD1306& display) {
+void displayPokemonData(const String& jsonString, NamiDisplay& display) {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
@@ -214,10 +214,10 @@ void displayPokemonData(const String& jsonString, Adafruit_SSD1306& display) {
 
 /**
  * Fetches a random Pokémon and displays it on the OLED display
- * @param display Reference to the Adafruit_SSD1306 display object
+ * @param display Reference to the NamiDisplay object
  * @return true if successful, false otherwise
  */
-bool fetchAndDisplayApi(Adafruit_SSD1306& display) {
+bool fetchAndDisplayApi(NamiDisplay& display) {
   String response = fetchRandomPokemon(display);
   displayPokemonData(response, display);
   return response.length() > 0;
@@ -0,0 +1,248 @@
+#ifndef ASYNC_HTTP_H
+#define ASYNC_HTTP_H
+
+#include <Arduino.h>
+#include <AsyncTCP.h>
+#include <atomic>
+#include "log.h"
+
+/**
+ * Non-blocking HTTP GET on top of AsyncTCP
+ *
+ * get() only queues the connect; the request is written and the response is
+ * collected by the AsyncTCP task in the background. The caller polls from
+ * its own loop and gets the finished response exactly once, so the parse
+ * and any render queue pushes stay on the caller's task.
+ *
+ * onFinished() registers a callback run on the AsyncTCP task when a
+ * response is complete, to wake a caller that sleeps between polls.
+ *
+ * Requests are sent as HTTP/1.0 with "Connection: close": the server closes
+ * the socket after the body and never uses chunked encoding, so the end of
+ * the connection is the end of the response.
+ */
+
+#define ASYNC_HTTP_RESPONSE_CAPACITY 1024  // Status line + headers + body
+#define ASYNC_HTTP_REQUEST_CAPACITY 192
+
+// Negative status codes (positive ones are HTTP status codes)
+#define ASYNC_HTTP_CONNECT_FAILED -1
+#define ASYNC_HTTP_TIMEOUT -2
+#define ASYNC_HTTP_BAD_RESPONSE -3
+#define ASYNC_HTTP_TOO_LARGE -4
+
+class AsyncHttpGet {
+public:
+  AsyncHttpGet() : state(HTTP_IDLE), received(0), overflow(false), startedAt(0), finishedAt(0), timeout(0),
+                   resultStatus(0), bodyStart(0), bodyLength(0), finishedCallback(nullptr) {
+    client.onConnect(handleConnect, this);
+    client.onData(handleData, this);
+    client.onDisconnect(handleDisconnect, this);
+    client.onError(handleError, this);
+  }
+
+  /**
+   * Starts a GET request without waiting for the connection
+   * @param host Server host name or IP address
+   * @param port Server port
+   * @param path Request path (e.g. "/info")
+   * @param timeoutMs Time allowed for the whole request, connect included
+   * @return true if the request was started, false if one is still running
+   */
+  bool get(const char* host, uint16_t port, const char* path, uint32_t timeoutMs) {
+    if (running()) {
+      return false;
+    }
+
+    int n = snprintf(request, sizeof(request),
+                     "GET %s HTTP/1.0\r\nHost: %s\r\nConnection: close\r\n\r\n", path, host);
+    if (n <= 0 || n >= (int)sizeof(request)) {
+      return false;
+    }
+
+    received = 0;
+    overflow = false;
+    startedAt = millis();
+    timeout = timeoutMs;
+    state.store(HTTP_RUNNING, std::memory_order_release);
+
+    if (!client.connect(host, port)) {
+      finish(ASYNC_HTTP_CONNECT_FAILED);
+    }
+    return true;
+  }
+
+  /**
+   * Sets the function called, from the AsyncTCP task, when a request ends
+   * @param callback Must be safe to call from another task
+   */
+  void onFinished(void (*callback)()) {
+    finishedCallback = callback;
+  }
+
+  /**
+   * @return milliseconds until the running request times out, 0 if none
+   */
+  uint32_t timeLeft() const {
+    if (state.load(std::memory_order_acquire) != HTTP_RUNNING) {
+      return 0;
+    }
+    unsigned long elapsed = millis() - startedAt;
+    return elapsed >= timeout ? 0 : timeout - elapsed;
+  }
+
+  /**
+   * @return true while a request is in flight
+   */
+  bool running() const {
+    return state.load(std::memory_order_acquire) != HTTP_IDLE;
+  }
+
+  /**
+   * Checks the request for completion and enforces the timeout
+   * @return true exactly once per request, when its result is ready
+   */
+  bool poll() {
+    uint8_t current = state.load(std::memory_order_acquire);
+    if (current == HTTP_RUNNING && millis() - startedAt >= timeout) {
+      if (finish(ASYNC_HTTP_TIMEOUT)) {
+        client.close(true);
+      }
+      current = state.load(std::memory_order_acquire);
+    }
+    if (current != HTTP_FINISHED) {
+      return false;
+    }
+
+    parseResponse();
+    state.store(HTTP_IDLE, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @return HTTP status code, or one of the negative ASYNC_HTTP_* codes
+   */
+  int status() const {
+    return resultStatus;
+  }
+
+  /**
+   * @return response body (not NUL terminated), valid until the next get()
+   */
+  const char* body() const {
+    return response + bodyStart;
+  }
+
+  size_t length() const {
+    return bodyLength;
+  }
+
+  /**
+   * @return time the last request took, in milliseconds
+   */
+  unsigned long elapsed() const {
+    return finishedAt - startedAt;
+  }
+
+private:
+  enum State : uint8_t { HTTP_IDLE, HTTP_RUNNING, HTTP_FINISHING, HTTP_FINISHED };
+
+  /**
+   * Marks the request as finished; only the first caller wins
+   * (a timeout can race with the AsyncTCP disconnect callback)
+   */
+  bool finish(int status) {
+    uint8_t expected = HTTP_RUNNING;
+    if (!state.compare_exchange_strong(expected, HTTP_FINISHING, std::memory_order_acq_rel)) {
+      return false;
+    }
+    resultStatus = status;
+    finishedAt = millis();
+    state.store(HTTP_FINISHED, std::memory_order_release);
+    if (finishedCallback != nullptr) {
+      finishedCallback();
+    }
+    return true;
+  }
+
+  /**
+   * Splits the raw response into status code and body
+   */
+  void parseResponse() {
+    bodyStart = 0;
+    bodyLength = 0;
+    if (resultStatus != 0) {
+      return;
+    }
+    if (overflow) {
+      resultStatus = ASYNC_HTTP_TOO_LARGE;
+      return;
+    }
+
+    // "HTTP/1.x NNN ..."
+    int code = 0;
+    if (received < 12 || memcmp(response, "HTTP/1.", 7) != 0 ||
+        sscanf(response + 9, "%3d", &code) != 1) {
+      resultStatus = ASYNC_HTTP_BAD_RESPONSE;
+      return;
+    }
+
+    for (size_t i = 0; i + 3 < received; i++) {
+      if (memcmp(response + i, "\r\n\r\n", 4) == 0) {
+        bodyStart = i + 4;
+        bodyLength = received - bodyStart;
+        resultStatus = code;
+        return;
+      }
+    }
+    resultStatus = ASYNC_HTTP_BAD_RESPONSE;
+  }
+
+  // --- AsyncTCP callbacks (run on the AsyncTCP task) ---
+
+  static void handleConnect(void* arg, AsyncClient* client) {
+    AsyncHttpGet* self = (AsyncHttpGet*)arg;
+    client->write(self->request, strlen(self->request));
+  }
+
+  static void handleData(void* arg, AsyncClient* client, void* data, size_t length) {
+    AsyncHttpGet* self = (AsyncHttpGet*)arg;
+    if (self->state.load(std::memory_order_acquire) != HTTP_RUNNING) {
+      return; // Timed out, the buffer belongs to the poller now
+    }
+    size_t space = sizeof(self->response) - self->received;
+    if (length > space) {
+      self->overflow = true;
+      length = space;
+    }
+    memcpy(self->response + self->received, data, length);
+    self->received += length;
+  }
+
+  static void handleDisconnect(void* arg, AsyncClient* client) {
+    // resultStatus 0 means "parse what was received"
+    ((AsyncHttpGet*)arg)->finish(0);
+  }
+
+  static void handleError(void* arg, AsyncClient* client, int8_t error) {
+    AsyncHttpGet* self = (AsyncHttpGet*)arg;
+    LOG_WARN("HTTP", "Connection error: %s", client->errorToString(error));
+    self->finish(ASYNC_HTTP_CONNECT_FAILED);
+  }
+
+  AsyncClient client;
+  std::atomic<uint8_t> state;
+  char request[ASYNC_HTTP_REQUEST_CAPACITY];
+  char response[ASYNC_HTTP_RESPONSE_CAPACITY];
+  size_t received;
+  bool overflow;
+  unsigned long startedAt;
+  unsigned long finishedAt;
+  uint32_t timeout;
+  int resultStatus;
+  size_t bodyStart;
+  size_t bodyLength;
+  void (*finishedCallback)();
+};
+
+#endif // ASYNC_HTTP_H
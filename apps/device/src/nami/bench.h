@@ -0,0 +1,376 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "nami_display.h"
+#include "pokemon_display.h"
+#include "text_layout.h"
+#include "text_scroller.h"
+#include "websocket_client.h"
+#include "wifi_connection.h"
+
+/**
+ * Micro-benchmarks for parsing, layout and drawing (NAMI_BENCH builds)
+ *
+ * Every case makes a fixed number of calls over a fixed corpus,
+ * BENCH_REPEATS times, timed with ESP.getCycleCount(). Once all cases are
+ * done the results are printed as CSV rows starting with "bench,", so they
+ * can be grepped out of the log and diffed between commits:
+ *
+ *   bench,case,calls,cycles_min,cycles_median,heap_bytes,flushed_bytes
+ *
+ * Cycles are per call, the minimum and the median over the repeats.
+ * heap_bytes is bytes allocated per call: every allocation in the host
+ * build, the net change of the free heap on the device. flushed_bytes is
+ * framebuffer bytes sent to the panel per call.
+ *
+ * Drawing cases alternate between two corpus entries, so every call
+ * changes the screen like a new frame from the server would.
+ */
+
+#define BENCH_VERSION 1
+#define BENCH_REPEATS 5
+#define BENCH_DRAW_CALLS 50
+#define BENCH_PARSE_CALLS 500
+#define BENCH_MAX_CASES 16
+#define BENCH_SPRITE_CAPACITY (64 * 64 / 8)
+#define BENCH_JSON_CAPACITY (BENCH_SPRITE_CAPACITY * 4 + 160)  // Up to "255," per byte
+
+// Bytes allocated since start; defined by the host build, which can count them
+uint64_t hostAllocatedBytes() __attribute__((weak));
+
+struct BenchSprite {
+  const char* name;
+  uint16_t id;
+  uint8_t width;
+  uint8_t height;
+  uint8_t raw[BENCH_SPRITE_CAPACITY];
+  size_t rawLength;
+  uint8_t rle[BENCH_SPRITE_CAPACITY + BENCH_SPRITE_CAPACITY / 128 + 1];
+  size_t rleLength;
+  char json[BENCH_JSON_CAPACITY];
+  size_t jsonLength;
+};
+
+struct BenchResult {
+  const char* name;
+  uint32_t calls;
+  uint32_t cyclesMin;
+  uint32_t cyclesMedian;
+  int32_t heapBytes;
+  uint32_t flushedBytes;
+};
+
+typedef void (*BenchCall)(NamiDisplay& display, uint32_t call);
+
+// --- Corpus ---
+
+// The boot logo (40x30), copied so that the corpus stays fixed if nami.ino changes
+const uint8_t benchLogo[] PROGMEM = {
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x01, 0x80, 0x3c, 0x00, 0x00, 0x01, 0x80, 0x7c,
+  0x00, 0x00, 0x01, 0x0c, 0xf8, 0x00, 0x00, 0x07, 0x9d, 0xf0, 0x00, 0x00, 0x0f, 0xfb, 0xe0, 0x00,
+  0x00, 0x0f, 0xf9, 0xc0, 0x00, 0x00, 0x1f, 0xb8, 0xe0, 0x00, 0x00, 0x1f, 0x3c, 0x60, 0x00, 0x00,
+  0x0f, 0xfe, 0xc0, 0x00, 0x00, 0x17, 0xfc, 0x00, 0x00, 0x00, 0x03, 0xdf, 0x00, 0x00, 0x00, 0x01,
+  0xb6, 0x00, 0x00, 0x00, 0x01, 0xcf, 0x00, 0x00, 0x00, 0x00, 0xfe, 0x00, 0x00, 0x00, 0x00, 0x1e,
+  0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+};
+
+const char* const benchMessages[2] = {
+  "Hey! Are we still on for lunch tomorrow at noon?",
+  "Reminder: the build server restarts tonight, so save your work before you leave.",
+};
+
+const char* const benchArts[2] = {
+  "   /\\_/\\\n  ( o.o )\n   > ^ <\n  /     \\\n (       )\n  \\__ __/",
+  "    /\\\n   /  \\\n  | () |\n  |    |\n /|    |\\\n/_|____|_\\\n   /\\/\\",
+};
+
+const char* const benchLongArt =
+  "  .-\"\"\"-.\n /       \\\n|  O   O  |\n|    ^    |\n|  \\___/  |\n \\       /\n  '-...-'\n"
+  "   |   |\n  /|   |\\\n / |   | \\\n   |   |\n   |___|\n   /   \\\n  /     \\\n";
+
+BenchSprite benchSprites[3];
+RenderFrame benchFrame;
+
+/**
+ * PackBits encoder matching the server's encodeRle (protocol.ts)
+ * @return encoded length
+ */
+size_t benchEncodeRle(const uint8_t* data, size_t length, uint8_t* out) {
+  size_t i = 0;
+  size_t o = 0;
+  while (i < length) {
+    size_t run = 1;
+    while (i + run < length && run < 128 && data[i + run] == data[i]) {
+      run++;
+    }
+    if (run >= 2) {
+      out[o++] = (uint8_t)(257 - run);
+      out[o++] = data[i];
+      i += run;
+      continue;
+    }
+
+    size_t start = i;
+    while (i < length && i - start < 128 && !(i + 1 < length && data[i + 1] == data[i])) {
+      i++;
+    }
+    if (i == start) {
+      i++;
+    }
+    out[o++] = (uint8_t)(i - start - 1);
+    memcpy(out + o, data + start, i - start);
+    o += i - start;
+  }
+  return o;
+}
+
+/**
+ * Fills in the encoded forms of a sprite whose raw bitmap is set
+ */
+void benchFinishSprite(BenchSprite& sprite) {
+  sprite.rleLength = benchEncodeRle(sprite.raw, sprite.rawLength, sprite.rle);
+
+  int n = snprintf(sprite.json, sizeof(sprite.json),
+                   "{\"type\":\"pokemon_bitmap\",\"data\":{\"pokemonId\":%u,\"pokemonName\":\"%s\","
+                   "\"width\":%u,\"height\":%u,\"bitmapData\":[",
+                   sprite.id, sprite.name, sprite.width, sprite.height);
+  for (size_t i = 0; i < sprite.rawLength && n < (int)sizeof(sprite.json); i++) {
+    n += snprintf(sprite.json + n, sizeof(sprite.json) - n, i ? ",%u" : "%u", sprite.raw[i]);
+  }
+  if (n < (int)sizeof(sprite.json)) {
+    n += snprintf(sprite.json + n, sizeof(sprite.json) - n, "]}}");
+  }
+  sprite.jsonLength = min((size_t)n, sizeof(sprite.json) - 1);
+}
+
+/**
+ * Builds the sprite corpus: the boot logo, an outlined and shaded blob
+ * (typical of Pokemon sprites) and a 64x64 dither (worst case for RLE)
+ */
+void benchBuildCorpus() {
+  BenchSprite& logo = benchSprites[0];
+  logo.name = "logo";
+  logo.id = 1;
+  logo.width = 40;
+  logo.height = 30;
+  logo.rawLength = sizeof(benchLogo);
+  memcpy(logo.raw, benchLogo, sizeof(benchLogo));
+  benchFinishSprite(logo);
+
+  BenchSprite& blob = benchSprites[1];
+  blob.name = "blob";
+  blob.id = 2;
+  blob.width = 40;
+  blob.height = 40;
+  blob.rawLength = 40 / 8 * 40;
+  memset(blob.raw, 0, blob.rawLength);
+  for (int y = 0; y < 40; y++) {
+    for (int x = 0; x < 40; x++) {
+      float dx = x - 19.5f;
+      float dy = y - 19.5f;
+      float angle = atan2f(dy, dx);
+      float radius = 14 + 3 * sinf(3 * angle) + 2 * cosf(5 * angle);
+      float d = sqrtf(dx * dx + dy * dy);
+      bool outline = fabsf(d - radius) < 1.0f;
+      bool shaded = d < radius && dx + dy > 4 && ((x + y) & 3) == 0;
+      if (outline || shaded) {
+        blob.raw[y * 5 + x / 8] |= 0x80 >> (x & 7);
+      }
+    }
+  }
+  benchFinishSprite(blob);
+
+  BenchSprite& dither = benchSprites[2];
+  dither.name = "dither";
+  dither.id = 3;
+  dither.width = 64;
+  dither.height = 64;
+  dither.rawLength = 64 / 8 * 64;
+  for (size_t i = 0; i < dither.rawLength; i++) {
+    dither.raw[i] = ((i / 8) & 1) ? 0x55 : 0xAA;
+  }
+  benchFinishSprite(dither);
+}
+
+// --- Cases ---
+
+void benchBitmapRaw(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[call & 1];
+  displayPokemonBitmap(display, s.id, s.name, s.width, s.height, s.raw, s.rawLength);
+}
+
+void benchBitmapRle(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[call & 1];
+  displayPokemonBitmap(display, s.id, s.name, s.width, s.height, s.rle, s.rleLength, FRAME_FLAG_RLE);
+}
+
+void benchBitmapSame(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[1];
+  displayPokemonBitmap(display, s.id, s.name, s.width, s.height, s.raw, s.rawLength);
+}
+
+void benchBitmapDither(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[2];
+  // Every other call blanks the screen, so every dither is drawn in full
+  if (call & 1) {
+    displayPokemonBitmap(display, s.id, s.name, s.width, s.height, s.rle, s.rleLength, FRAME_FLAG_RLE);
+  } else {
+    display.clearDisplay();
+    display.display();
+  }
+}
+
+void benchParseJson(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[call & 1];
+  parsePokemonBitmapJson(s.json, s.jsonLength, benchFrame);
+}
+
+void benchParseAndDisplay(NamiDisplay& display, uint32_t call) {
+  const BenchSprite& s = benchSprites[call & 1];
+  if (parsePokemonBitmapJson(s.json, s.jsonLength, benchFrame)) {
+    displayPokemonBitmap(display, benchFrame.id, benchFrame.name, benchFrame.width, benchFrame.height,
+                         benchFrame.data, benchFrame.length, benchFrame.flags);
+  }
+}
+
+void benchAsciiArt(NamiDisplay& display, uint32_t call) {
+  const char* art = benchArts[call & 1];
+  displayAsciiArt(display, art, strlen(art));
+}
+
+void benchMessage(NamiDisplay& display, uint32_t call) {
+  const char* message = benchMessages[call & 1];
+  displayMessage(display, message, strlen(message));
+}
+
+void benchWordWrap(NamiDisplay& display, uint32_t call) {
+  const char* message = benchMessages[call & 1];
+  TextLayout layout;
+  layoutText(message, strlen(message), TEXT_COLUMNS, TEXT_MAX_LINES, TEXT_WRAP_WORDS, layout);
+}
+
+void benchCenterText(NamiDisplay& display, uint32_t call) {
+  volatile int x = centerText((call & 1) ? "Connecting..." : "WiFi Connected!");
+  (void)x;
+}
+
+void benchScrollStep(NamiDisplay& display, uint32_t call) {
+  if (!textScroller.active) {
+    startTextScroll(display, SCROLL_ASCII_ART, benchLongArt, strlen(benchLongArt));
+  }
+  // Every call is a due step, the hold times are skipped
+  textScroller.nextStepAt = millis();
+  serviceTextScroll(display);
+}
+
+// --- Runner ---
+
+BenchResult benchResults[BENCH_MAX_CASES];
+int benchResultCount = 0;
+
+/**
+ * @return bytes allocated so far (host), or heap in use (device)
+ */
+int64_t benchHeapMark() {
+  if (hostAllocatedBytes) {
+    return (int64_t)hostAllocatedBytes();
+  }
+  return -(int64_t)ESP.getFreeHeap();
+}
+
+/**
+ * Times calls of one case and records the result
+ * @param display Reference to the NamiDisplay object
+ * @param name Case name, as printed in the CSV
+ * @param fn Function under test
+ * @param calls Calls per repeat
+ */
+void benchRun(NamiDisplay& display, const char* name, BenchCall fn, uint32_t calls) {
+  if (benchResultCount >= BENCH_MAX_CASES) {
+    return;
+  }
+
+  // One warm-up call, so lazy allocations do not count against the case
+  fn(display, 0);
+
+  uint32_t perCall[BENCH_REPEATS];
+  int64_t heapBefore = benchHeapMark();
+  uint32_t flushedBefore = display.flushedBytes();
+  for (int r = 0; r < BENCH_REPEATS; r++) {
+    uint32_t start = ESP.getCycleCount();
+    for (uint32_t i = 0; i < calls; i++) {
+      fn(display, i);
+    }
+    perCall[r] = (ESP.getCycleCount() - start) / calls;
+  }
+  uint32_t total = calls * BENCH_REPEATS;
+  int64_t heap = benchHeapMark() - heapBefore;
+  uint32_t flushed = display.flushedBytes() - flushedBefore;
+
+  for (int i = 1; i < BENCH_REPEATS; i++) {
+    for (int j = i; j > 0 && perCall[j] < perCall[j - 1]; j--) {
+      uint32_t t = perCall[j];
+      perCall[j] = perCall[j - 1];
+      perCall[j - 1] = t;
+    }
+  }
+  BenchResult& result = benchResults[benchResultCount++];
+  result.name = name;
+  result.calls = calls;
+  result.cyclesMin = perCall[0];
+  result.cyclesMedian = perCall[BENCH_REPEATS / 2];
+  result.heapBytes = (int32_t)(heap / (int64_t)total);
+  result.flushedBytes = flushed / total;
+}
+
+/**
+ * Runs every case and prints the results as CSV
+ * @param display Reference to the NamiDisplay object (its content is lost)
+ */
+void runBenchmarks(NamiDisplay& display) {
+  Serial.println("[Bench] Building corpus");
+  benchBuildCorpus();
+  benchResultCount = 0;
+
+  benchRun(display, "bitmap_raw", benchBitmapRaw, BENCH_DRAW_CALLS);
+  benchRun(display, "bitmap_rle", benchBitmapRle, BENCH_DRAW_CALLS);
+  benchRun(display, "bitmap_same", benchBitmapSame, BENCH_DRAW_CALLS);
+  benchRun(display, "bitmap_dither_rle", benchBitmapDither, BENCH_DRAW_CALLS);
+  benchRun(display, "parse_json", benchParseJson, BENCH_PARSE_CALLS);
+  benchRun(display, "parse_and_display", benchParseAndDisplay, BENCH_DRAW_CALLS);
+  benchRun(display, "ascii_art", benchAsciiArt, BENCH_DRAW_CALLS);
+  benchRun(display, "message", benchMessage, BENCH_DRAW_CALLS);
+  benchRun(display, "word_wrap", benchWordWrap, BENCH_PARSE_CALLS);
+  benchRun(display, "center_text", benchCenterText, BENCH_PARSE_CALLS);
+  benchRun(display, "scroll_step", benchScrollStep, BENCH_DRAW_CALLS);
+  stopTextScroll();
+
+  Serial.print("# nami-bench ");
+  Serial.print(BENCH_VERSION);
+  Serial.print(", ");
+  Serial.print(ESP.getCpuFreqMHz());
+  Serial.print(" MHz, heap_bytes ");
+  Serial.println(hostAllocatedBytes ? "allocated" : "net");
+  Serial.println("bench,case,calls,cycles_min,cycles_median,heap_bytes,flushed_bytes");
+  for (int i = 0; i < benchResultCount; i++) {
+    const BenchResult& result = benchResults[i];
+    Serial.print("bench,");
+    Serial.print(result.name);
+    Serial.print(",");
+    Serial.print(result.calls);
+    Serial.print(",");
+    Serial.print(result.cyclesMin);
+    Serial.print(",");
+    Serial.print(result.cyclesMedian);
+    Serial.print(",");
+    Serial.print(result.heapBytes);
+    Serial.print(",");
+    Serial.println(result.flushedBytes);
+  }
+}
+
+#endif // BENCH_H
@@ -0,0 +1,204 @@
+#ifndef BITMAP_BLIT_H
+#define BITMAP_BLIT_H
+
+#include <Arduino.h>
+
+/**
+ * 1bpp blit engine writing straight into the SSD1306 framebuffer
+ *
+ * Source bitmaps are row-major, MSB first (bit 7 is the leftmost pixel),
+ * which is what the server produces. The SSD1306 buffer is page-major:
+ * one byte covers 8 vertical pixels of a column, LSB on top. Instead of
+ * converting one pixel at a time, every 8x8 block is transposed with a few
+ * shift/mask steps and written as 8 column bytes.
+ */
+
+enum BlitMode : uint8_t {
+  BLIT_OR,         // Set pixels are drawn, clear pixels leave the screen untouched
+  BLIT_OVERWRITE,  // The bitmap rectangle replaces whatever was on screen
+  BLIT_XOR,        // Set pixels invert the screen
+};
+
+/**
+ * Transposes an 8x8 bit block from row-major (MSB left) to column bytes
+ * (LSB top), using the 32-bit variant of the classic recursive swap
+ * @param rows 8 source row bytes, rows[0] being the top row
+ * @param columns 8 output column bytes, columns[0] being the leftmost column
+ */
+inline void transposeBlock8x8(const uint8_t rows[8], uint8_t columns[8]) {
+  // Pack rows in reverse so that row 0 ends up in bit 0 of every column
+  uint32_t hi = ((uint32_t)rows[7] << 24) | ((uint32_t)rows[6] << 16) | ((uint32_t)rows[5] << 8) | rows[4];
+  uint32_t lo = ((uint32_t)rows[3] << 24) | ((uint32_t)rows[2] << 16) | ((uint32_t)rows[1] << 8) | rows[0];
+  uint32_t t;
+
+  // Swap 1x1 blocks, then 2x2 blocks inside each 4x4 quadrant
+  t = (hi ^ (hi >> 7)) & 0x00AA00AA; hi = hi ^ t ^ (t << 7);
+  t = (lo ^ (lo >> 7)) & 0x00AA00AA; lo = lo ^ t ^ (t << 7);
+  t = (hi ^ (hi >> 14)) & 0x0000CCCC; hi = hi ^ t ^ (t << 14);
+  t = (lo ^ (lo >> 14)) & 0x0000CCCC; lo = lo ^ t ^ (t << 14);
+
+  // Swap the two off-diagonal 4x4 quadrants
+  t = (hi & 0xF0F0F0F0) | ((lo >> 4) & 0x0F0F0F0F);
+  lo = ((hi << 4) & 0xF0F0F0F0) | (lo & 0x0F0F0F0F);
+  hi = t;
+
+  columns[0] = hi >> 24; columns[1] = hi >> 16; columns[2] = hi >> 8; columns[3] = hi;
+  columns[4] = lo >> 24; columns[5] = lo >> 16; columns[6] = lo >> 8; columns[7] = lo;
+}
+
+/**
+ * Writes one column byte (8 vertical pixels) at an arbitrary y offset,
+ * splitting it across two pages when y is not page aligned
+ */
+inline void blitColumn(
+  uint8_t* buffer,
+  int bufferWidth,
+  int pageCount,
+  int x,
+  int page,
+  int shift,
+  uint8_t bits,
+  uint8_t rowMask,
+  BlitMode mode
+) {
+  uint16_t shiftedBits = (uint16_t)bits << shift;
+  uint16_t shiftedMask = (uint16_t)rowMask << shift;
+
+  for (int half = 0; half < 2; half++) {
+    int p = page + half;
+    uint8_t mask = shiftedMask >> (8 * half);
+    if (mask == 0 || p < 0 || p >= pageCount) {
+      continue;
+    }
+
+    uint8_t value = shiftedBits >> (8 * half);
+    uint8_t* dst = buffer + p * bufferWidth + x;
+    switch (mode) {
+      case BLIT_OR:
+        *dst |= value;
+        break;
+      case BLIT_XOR:
+        *dst ^= value;
+        break;
+      case BLIT_OVERWRITE:
+        *dst = (*dst & ~mask) | value;
+        break;
+    }
+  }
+}
+
+/**
+ * Blits a band of up to 8 source rows into a page-major framebuffer
+ *
+ * @param buffer SSD1306 framebuffer (bufferWidth * bufferHeight / 8 bytes)
+ * @param bufferWidth Framebuffer width in pixels
+ * @param bufferHeight Framebuffer height in pixels (multiple of 8)
+ * @param x Destination x of the band's left edge (may be negative)
+ * @param y Destination y of the band's top row (may be negative)
+ * @param rows First source row of the band
+ * @param stride Bytes per source row
+ * @param width Bitmap width in pixels
+ * @param rowCount Number of valid rows in the band (1..8)
+ * @param mode How the band is combined with the framebuffer
+ */
+void blitBand(
+  uint8_t* buffer,
+  int bufferWidth,
+  int bufferHeight,
+  int x,
+  int y,
+  const uint8_t* rows,
+  size_t stride,
+  int width,
+  int rowCount,
+  BlitMode mode
+) {
+  if (rowCount <= 0) {
+    return;
+  }
+  if (rowCount > 8) {
+    rowCount = 8;
+  }
+
+  int pageCount = bufferHeight / 8;
+  if (y >= bufferHeight || y + rowCount <= 0) {
+    return;
+  }
+
+  // Floor division, so that negative offsets start on the page above the screen
+  int page = (y >= 0) ? y / 8 : -((7 - y) / 8);
+  int shift = y - page * 8;
+  uint8_t rowMask = (uint8_t)((1u << rowCount) - 1);
+
+  uint8_t block[8];
+  uint8_t columns[8];
+
+  for (size_t bx = 0; bx < stride; bx++) {
+    int blockX = x + (int)bx * 8;
+    if (blockX >= bufferWidth) {
+      break;
+    }
+    if (blockX + 8 <= 0) {
+      continue;
+    }
+
+    uint8_t any = 0;
+    for (int i = 0; i < 8; i++) {
+      block[i] = (i < rowCount) ? rows[i * stride + bx] : 0;
+      any |= block[i];
+    }
+
+    // Empty blocks are a no-op for OR and XOR, which skips most sprite background
+    if (!any && mode != BLIT_OVERWRITE) {
+      continue;
+    }
+
+    transposeBlock8x8(block, columns);
+
+    for (int c = 0; c < 8; c++) {
+      int sourceX = (int)bx * 8 + c;
+      int px = blockX + c;
+      if (sourceX >= width || px >= bufferWidth) {
+        break;
+      }
+      if (px < 0) {
+        continue;
+      }
+      blitColumn(buffer, bufferWidth, pageCount, px, page, shift, columns[c], rowMask, mode);
+    }
+  }
+}
+
+/**
+ * Blits a whole row-major 1bpp bitmap into a page-major framebuffer,
+ * clipping against the framebuffer edges
+ *
+ * @param buffer SSD1306 framebuffer (display.getBuffer())
+ * @param bufferWidth Framebuffer width in pixels
+ * @param bufferHeight Framebuffer height in pixels (multiple of 8)
+ * @param x Destination x (may be negative)
+ * @param y Destination y (may be negative)
+ * @param bitmap Source bitmap, (width + 7) / 8 bytes per row
+ * @param width Bitmap width in pixels
+ * @param height Bitmap height in pixels
+ * @param mode How the bitmap is combined with the framebuffer
+ */
+void blitBitmap(
+  uint8_t* buffer,
+  int bufferWidth,
+  int bufferHeight,
+  int x,
+  int y,
+  const uint8_t* bitmap,
+  int width,
+  int height,
+  BlitMode mode
+) {
+  size_t stride = (width + 7) / 8;
+  for (int row = 0; row < height; row += 8) {
+    int rowCount = min(8, height - row);
+    blitBand(buffer, bufferWidth, bufferHeight, x, y + row, bitmap + row * stride, stride, width, rowCount, mode);
+  }
+}
+
+#endif // BITMAP_BLIT_H
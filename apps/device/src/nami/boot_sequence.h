@@ -0,0 +1,271 @@
+#ifndef BOOT_SEQUENCE_H
+#define BOOT_SEQUENCE_H
+
+#include <Preferences.h>
+#include "nami_display.h"
+#include "wifi_connection.h"
+#include "websocket_client.h"
+#include "connection_supervisor.h"
+#include "device_tasks.h"
+#include "log.h"
+
+/**
+ * Cooperative boot sequence
+ *
+ * WiFi association starts right away and the WebSocket handshake starts as
+ * soon as an IP address is available, while the splash and "setting up"
+ * screens keep animating. Call bootStep() from loop() until it returns
+ * true, then hand over with startDeviceTasks(). Between steps the loop
+ * task sleeps for bootWaitTime(), or until a WiFi event or server data
+ * wakes it (event_loop.h).
+ *
+ * bootStep() does not wait, with two exceptions:
+ *   - a WebSocket attempt's DNS lookup and TCP connect run inside
+ *     webSocket.loop() and block until they finish or time out. The
+ *     supervisor makes one such connect per backoff window, so with the
+ *     server down the animation stalls once per retry, not on every step.
+ *   - when WiFi never comes up, the failure screen is held for 3 s before
+ *     the restart.
+ *
+ * Fast boot skips every cosmetic hold, so the device is ready as soon as
+ * the radio and the server allow. It is enabled at compile time with
+ * -DNAMI_FAST_BOOT=1, or at runtime with the "fastBoot" bool key in the
+ * "nami" NVS namespace (which takes precedence).
+ */
+
+#ifndef NAMI_FAST_BOOT
+#define NAMI_FAST_BOOT 0
+#endif
+
+#define BOOT_SPLASH_HOLD 2000       // Splash screen hold (ms)
+#define BOOT_SETUP_HOLD 5000        // Minimum "setting up your nami" time (ms)
+#define BOOT_CONNECTED_HOLD 2000    // "WiFi Connected!" / "Connected!" hold (ms)
+#define BOOT_DOT_INTERVAL 500       // Setup animation step (ms)
+#define BOOT_WIFI_TIMEOUT 30000     // Restart if WiFi is not up after this long (ms)
+#define BOOT_WEBSOCKET_TIMEOUT 10000
+
+enum BootState {
+  BOOT_SPLASH,
+  BOOT_SETUP,
+  BOOT_WIFI_CONNECTED,
+  BOOT_WEBSOCKET,
+  BOOT_WEBSOCKET_CONNECTED,
+  BOOT_INFO,
+  BOOT_READY,
+};
+
+struct BootSequence {
+  BootState state;
+  unsigned long bootStart;
+  unsigned long stateStart;
+  unsigned long lastDot;
+  int dotCount;
+  bool fastBoot;
+  bool wifiReported;
+  uint32_t networkWait;  // Sleep allowed by the connection supervisor (ms)
+  bool advanced;         // The last step entered a new state
+};
+
+BootSequence boot;
+
+/**
+ * Reads the fast boot setting, NVS first, then the compile-time default
+ * @return true if cosmetic holds should be skipped
+ */
+bool readFastBootSetting() {
+  Preferences prefs;
+  bool fastBoot = NAMI_FAST_BOOT;
+  // Read-only open fails when the namespace has never been written
+  if (prefs.begin("nami", true)) {
+    fastBoot = prefs.getBool("fastBoot", fastBoot);
+    prefs.end();
+  }
+  return fastBoot;
+}
+
+/**
+ * Switches to a new boot state and restarts its timer
+ */
+void enterBootState(BootState state) {
+  boot.state = state;
+  boot.stateStart = millis();
+  boot.advanced = true;
+}
+
+/**
+ * Draws the "setting up your nami" screen with the current number of dots
+ */
+void drawSetupScreen(NamiDisplay& display) {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  const char* setupText = "setting up your nami";
+  display.setCursor(centerText(setupText), 25);
+  display.print(setupText);
+
+  // Display dots (one at a time, looping through 3)
+  static const char* const dots[] = {"", ".", ".."};
+  const char* dotText = dots[boot.dotCount];
+  display.setCursor(centerText(dotText), 35);
+  display.print(dotText);
+  display.display();
+}
+
+/**
+ * Starts the boot sequence
+ * The splash screen is expected to be on the display already.
+ * @param display Reference to the NamiDisplay object
+ */
+void bootBegin(NamiDisplay& display) {
+  boot.fastBoot = readFastBootSetting();
+  boot.bootStart = millis();
+  boot.lastDot = 0;
+  boot.dotCount = 0;
+  boot.wifiReported = false;
+
+  LOG_INFO("Boot", "Fast boot: %s", boot.fastBoot ? "on" : "off");
+
+  // The radio needs the most time, so start it first
+  beginEventLoop();
+  beginConnection();
+  spriteCacheBegin();
+  enterBootState(BOOT_SPLASH);
+}
+
+/**
+ * Advances the boot sequence by one non-blocking step
+ * @param display Reference to the NamiDisplay object
+ * @return true once the device is ready
+ */
+bool bootStep(NamiDisplay& display) {
+  unsigned long now = millis();
+  boot.advanced = false;
+
+  // --- Network progress, independent of the screen being shown ---
+  // The supervisor starts the WebSocket as soon as there is an address
+  boot.networkWait = superviseConnection();
+  bool wifiConnected = connectionHasIp();
+  if (wifiConnected && !boot.wifiReported) {
+    LOG_INFO("Boot", "WiFi connected after %lu ms", now - boot.bootStart);
+    boot.wifiReported = true;
+  }
+
+  // The render task is not running yet, so draw queued frames here
+  renderPendingFrames(display);
+
+  if (!wifiConnected && now - boot.bootStart >= BOOT_WIFI_TIMEOUT) {
+    showWiFiFailed(display);
+    delay(3000);
+    ESP.restart(); // Restart ESP32 to retry connection
+    return false;
+  }
+
+  // Holds only apply while nothing from the server is on screen
+  bool cosmetic = !boot.fastBoot && !serverFrameShown;
+  unsigned long elapsed = now - boot.stateStart;
+
+  switch (boot.state) {
+    case BOOT_SPLASH:
+      if (!cosmetic || elapsed >= BOOT_SPLASH_HOLD) {
+        enterBootState(BOOT_SETUP);
+      }
+      break;
+
+    case BOOT_SETUP:
+      if (wifiConnected && (!cosmetic || elapsed >= BOOT_SETUP_HOLD)) {
+        if (cosmetic) {
+          showWiFiConnected(display);
+        }
+        enterBootState(BOOT_WIFI_CONNECTED);
+      } else if (!serverFrameShown && now - boot.lastDot >= BOOT_DOT_INTERVAL) {
+        drawSetupScreen(display);
+        boot.lastDot = now;
+        boot.dotCount = (boot.dotCount + 1) % 3;
+      }
+      break;
+
+    case BOOT_WIFI_CONNECTED:
+      if (!cosmetic || elapsed >= BOOT_CONNECTED_HOLD) {
+        if (!webSocket.isConnected() && !serverFrameShown) {
+          showWebSocketStatus(display, "Connecting...");
+        }
+        enterBootState(BOOT_WEBSOCKET);
+      }
+      break;
+
+    case BOOT_WEBSOCKET:
+      if (webSocket.isConnected()) {
+        LOG_INFO("Boot", "WebSocket connected after %lu ms", now - boot.bootStart);
+        if (cosmetic) {
+          showWebSocketStatus(display, "Connected!");
+        }
+        enterBootState(BOOT_WEBSOCKET_CONNECTED);
+      } else if (elapsed >= BOOT_WEBSOCKET_TIMEOUT) {
+        LOG_WARN("Boot", "WebSocket connection failed, retrying in the background");
+        if (!serverFrameShown) {
+          showWebSocketStatus(display, "Failed!");
+        }
+        enterBootState(BOOT_WEBSOCKET_CONNECTED);
+      }
+      break;
+
+    case BOOT_WEBSOCKET_CONNECTED:
+      if (!cosmetic || elapsed >= BOOT_CONNECTED_HOLD) {
+        enterBootState(BOOT_INFO);
+      }
+      break;
+
+    case BOOT_INFO:
+      // The server pushes an info snapshot, then only the fields that change
+      if (subscribeSystemInfo()) {
+        LOG_INFO("Boot", "Subscribed to system info");
+      } else if (!serverFrameShown) {
+        // Completed by the network task once it is running
+        LOG_INFO("Boot", "Fetching system info from /info endpoint...");
+        requestSystemInfo();
+        renderPendingFrames(display);
+      }
+      LOG_INFO("Boot", "Ready after %lu ms", millis() - boot.bootStart);
+      enterBootState(BOOT_READY);
+      break;
+
+    case BOOT_READY:
+      break;
+  }
+
+  return boot.state == BOOT_READY;
+}
+
+/**
+ * @return milliseconds until the boot sequence has something to do, unless
+ *         the network wakes it first
+ */
+uint32_t bootWaitTime() {
+  if (boot.advanced) {
+    // The new state may be able to move on right away
+    return 0;
+  }
+  unsigned long now = millis();
+  bool cosmetic = !boot.fastBoot && !serverFrameShown;
+  uint32_t wait = min(boot.networkWait, timeUntilDue(boot.bootStart, BOOT_WIFI_TIMEOUT, now));
+
+  switch (boot.state) {
+    case BOOT_SPLASH:
+      return cosmetic ? min(wait, timeUntilDue(boot.stateStart, BOOT_SPLASH_HOLD, now)) : 0;
+    case BOOT_SETUP:
+      if (!serverFrameShown) {
+        wait = min(wait, timeUntilDue(boot.lastDot, BOOT_DOT_INTERVAL, now));
+      }
+      return cosmetic && connectionHasIp() ? min(wait, timeUntilDue(boot.stateStart, BOOT_SETUP_HOLD, now)) : wait;
+    case BOOT_WIFI_CONNECTED:
+    case BOOT_WEBSOCKET_CONNECTED:
+      return cosmetic ? min(wait, timeUntilDue(boot.stateStart, BOOT_CONNECTED_HOLD, now)) : 0;
+    case BOOT_WEBSOCKET:
+      return min(wait, timeUntilDue(boot.stateStart, BOOT_WEBSOCKET_TIMEOUT, now));
+    default:
+      return 0;
+  }
+}
+
+#endif // BOOT_SEQUENCE_H
@@ -0,0 +1,268 @@
+#ifndef CONNECTION_SUPERVISOR_H
+#define CONNECTION_SUPERVISOR_H
+
+#include <atomic>
+#include "wifi_connection.h"
+#include "websocket_client.h"
+#include "log.h"
+
+/**
+ * Connection supervisor
+ *
+ * One state machine for the WiFi link, the IP address and the WebSocket,
+ * stepped by whichever task owns the network (the boot sequence, then the
+ * network task). WiFi events (WiFi.onEvent, delivered on the WiFi event
+ * task) only raise flags; every retry is scheduled here, with jittered
+ * exponential backoff, so neither the driver nor the WebSocket library
+ * retries on its own (each socket attempt makes exactly one connect, see
+ * beginWebSocket()):
+ *
+ *   WIFI_DOWN -> WIFI_JOINING -> IP_UP -> SOCKET_OPENING -> ONLINE
+ *
+ * Losing the link from any state closes the socket and goes back to
+ * WIFI_DOWN; losing the socket, or an attempt timing out, goes back one
+ * step. The first retry after a loss is immediate, the next ones wait
+ * SUPERVISOR_BACKOFF_MIN doubling up to SUPERVISOR_BACKOFF_MAX, so the
+ * time to recover once the network is back is bounded. Every outage is
+ * timed from the loss to ONLINE and reported with the metrics.
+ *
+ * webSocket.loop() runs on every step while a socket is opening or open,
+ * so the handshake and the heartbeat always progress. Each step returns
+ * how long the caller may sleep before the next one (see event_loop.h);
+ * WiFi events wake it up early. On reconnect the identify message carries
+ * "resume":1 and the server sends the current screen again.
+ */
+
+#define SUPERVISOR_BACKOFF_MIN 250      // First delayed retry (ms)
+#define SUPERVISOR_BACKOFF_MAX 30000    // Longest wait between attempts (ms)
+#define SUPERVISOR_SOCKET_TIMEOUT 5000  // One WebSocket connect and handshake (ms)
+#define SUPERVISOR_CONNECTING_WAKE 100  // Longest sleep while joining or opening (ms)
+#define SUPERVISOR_ONLINE_WAKE 1000     // Longest sleep while online, paces the heartbeat (ms)
+
+// Flags raised by the WiFi event task
+#define WIFI_EVENT_LINK_LOST (1 << 0)
+#define WIFI_EVENT_GOT_IP (1 << 1)
+
+enum ConnectionState : uint8_t {
+  CONN_WIFI_DOWN,       // No link, next join attempt scheduled
+  CONN_WIFI_JOINING,    // Join attempt in progress
+  CONN_IP_UP,           // Link and address up, next socket attempt scheduled
+  CONN_SOCKET_OPENING,  // WebSocket connect and handshake in progress
+  CONN_ONLINE,          // WebSocket open
+};
+
+struct ConnectionSupervisor {
+  ConnectionState state;
+  unsigned long stateSince;
+  unsigned long nextAttemptAt;
+  uint8_t failures;       // Consecutive failed attempts of the current step
+  bool outage;            // Lost the connection, not back yet
+  unsigned long outageSince;
+  uint32_t outages;
+  uint32_t lastRecovery;  // Milliseconds from loss to ONLINE
+  uint32_t worstRecovery;
+};
+
+ConnectionSupervisor supervisor = {CONN_WIFI_DOWN};
+std::atomic<uint32_t> wifiEvents(0);
+
+static const char* const connectionStateNames[] = {
+  "wifi down", "joining", "ip up", "socket opening", "online",
+};
+
+/**
+ * WiFi event handler, runs on the WiFi event task
+ */
+void onWiFiEvent(WiFiEvent_t event) {
+  switch (event) {
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      wifiEvents.fetch_or(WIFI_EVENT_LINK_LOST);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      wifiEvents.fetch_or(WIFI_EVENT_GOT_IP);
+      break;
+    default:
+      return;
+  }
+  wakeNetworkTask();
+}
+
+/**
+ * @return delay before the next attempt after the given number of failures
+ */
+unsigned long backoffDelay(uint8_t failures) {
+  unsigned long ceiling = min((unsigned long)SUPERVISOR_BACKOFF_MAX,
+                              (unsigned long)SUPERVISOR_BACKOFF_MIN << min((int)failures, 8));
+  // Jitter over the upper half, so devices that lost the same AP spread out
+  return ceiling / 2 + random(ceiling / 2 + 1);
+}
+
+void enterConnectionState(ConnectionState state) {
+  ConnectionSupervisor& sup = supervisor;
+  LOG_INFO("Net", "%s -> %s", connectionStateNames[sup.state], connectionStateNames[state]);
+  sup.state = state;
+  sup.stateSince = millis();
+}
+
+/**
+ * Schedules the next attempt of the current step after a failure
+ */
+void scheduleRetry(ConnectionState state) {
+  ConnectionSupervisor& sup = supervisor;
+  unsigned long delay = backoffDelay(sup.failures);
+  if (sup.failures < 255) {
+    sup.failures++;
+  }
+  sup.nextAttemptAt = millis() + delay;
+  LOG_INFO("Net", "Retrying in %lu ms", delay);
+  enterConnectionState(state);
+}
+
+/**
+ * Starts timing an outage (the connection was up and got lost)
+ */
+void beginOutage() {
+  ConnectionSupervisor& sup = supervisor;
+  if (!sup.outage) {
+    sup.outage = true;
+    sup.outageSince = millis();
+    sup.outages++;
+  }
+  // The first retry after a loss is immediate
+  sup.failures = 0;
+  sup.nextAttemptAt = millis();
+}
+
+/**
+ * Starts connecting: WiFi events, then the first join attempt
+ * Call once, before the first superviseConnection().
+ */
+void beginConnection() {
+  // The supervisor schedules every retry
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(onWiFiEvent);
+  beginWiFi();
+  supervisor.state = CONN_WIFI_JOINING;
+  supervisor.stateSince = millis();
+}
+
+/**
+ * @return true while WiFi is up with an address
+ */
+bool connectionHasIp() {
+  return supervisor.state >= CONN_IP_UP;
+}
+
+/**
+ * @return milliseconds until a scheduled attempt is due, 0 if due now
+ */
+uint32_t timeUntilAttempt(unsigned long now) {
+  long left = (long)(supervisor.nextAttemptAt - now);
+  return left > 0 ? (uint32_t)left : 0;
+}
+
+/**
+ * Advances the connection by one non-blocking step
+ * Must be called regularly from the task that owns the WebSocket.
+ * @return milliseconds until the next step is needed, unless an event
+ *         (WiFi, socket data) comes first
+ */
+uint32_t superviseConnection() {
+  ConnectionSupervisor& sup = supervisor;
+  unsigned long now = millis();
+  uint32_t events = wifiEvents.exchange(0);
+
+  // Failed join attempts report disconnects too; only a lost link counts here
+  if ((events & WIFI_EVENT_LINK_LOST) && sup.state >= CONN_IP_UP && WiFi.status() != WL_CONNECTED) {
+    LOG_WARN("Net", "WiFi link lost");
+    webSocket.disconnect();
+    queueStatus("WiFi", "Disconnected", "Reconnecting...");
+    beginOutage();
+    enterConnectionState(CONN_WIFI_DOWN);
+  }
+
+  ConnectionState stepState = sup.state;
+  switch (sup.state) {
+    case CONN_WIFI_DOWN:
+      if ((long)(now - sup.nextAttemptAt) < 0) {
+        return timeUntilAttempt(now);
+      }
+      startWiFiAttempt(true);
+      enterConnectionState(CONN_WIFI_JOINING);
+      break;
+
+    case CONN_WIFI_JOINING: {
+      // GOT_IP ends the join; serviceWiFi() runs the AP fallback and the
+      // timeouts. If the link dropped again in the same batch, the status
+      // decides.
+      bool joined;
+      if ((events & WIFI_EVENT_GOT_IP) && !(events & WIFI_EVENT_LINK_LOST)) {
+        finishWiFiAttempt();
+        joined = true;
+      } else {
+        joined = serviceWiFi();
+      }
+      if (joined) {
+        sup.failures = 0;
+        sup.nextAttemptAt = now;
+        enterConnectionState(CONN_IP_UP);
+      } else if (!wifiLink.connecting) {
+        // Neither the cached AP nor a scan worked
+        scheduleRetry(CONN_WIFI_DOWN);
+      }
+      break;
+    }
+
+    case CONN_IP_UP:
+      if ((long)(now - sup.nextAttemptAt) < 0) {
+        return timeUntilAttempt(now);
+      }
+      beginWebSocket(SUPERVISOR_SOCKET_TIMEOUT);
+      enterConnectionState(CONN_SOCKET_OPENING);
+      break;
+
+    case CONN_SOCKET_OPENING:
+      webSocket.loop();
+      if (webSocket.isConnected()) {
+        sup.failures = 0;
+        enterConnectionState(CONN_ONLINE);
+        if (sup.outage) {
+          sup.outage = false;
+          sup.lastRecovery = millis() - sup.outageSince;
+          sup.worstRecovery = max(sup.worstRecovery, sup.lastRecovery);
+          LOG_INFO("Net", "Recovered after %u ms", (unsigned)sup.lastRecovery);
+        }
+      } else if (webSocket.connectFailed()) {
+        // The library does not retry within the window; back off from here
+        LOG_WARN("Net", "WebSocket connect failed");
+        webSocket.disconnect();
+        scheduleRetry(CONN_IP_UP);
+      } else if (now - sup.stateSince >= SUPERVISOR_SOCKET_TIMEOUT) {
+        LOG_WARN("Net", "WebSocket connect timed out");
+        webSocket.disconnect();
+        scheduleRetry(CONN_IP_UP);
+      }
+      break;
+
+    case CONN_ONLINE:
+      webSocket.loop();
+      if (!webSocket.isConnected()) {
+        LOG_WARN("Net", "WebSocket lost");
+        beginOutage();
+        enterConnectionState(CONN_IP_UP);
+        return 0;
+      }
+      sendFrameAcks();
+      sendRemoteLogs();
+      // Data the library already read from the socket is not seen by select()
+      return webSocket.hasBufferedData() ? 0 : SUPERVISOR_ONLINE_WAKE;
+  }
+  if (sup.state != stepState) {
+    // Start the new state right away
+    return 0;
+  }
+  return sup.state == CONN_IP_UP || sup.state == CONN_WIFI_DOWN ? timeUntilAttempt(now) : SUPERVISOR_CONNECTING_WAKE;
+}
+
+#endif // CONNECTION_SUPERVISOR_H
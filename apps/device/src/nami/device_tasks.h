@@ -0,0 +1,299 @@
+#ifndef DEVICE_TASKS_H
+#define DEVICE_TASKS_H
+
+#include "nami_display.h"
+#include "render_queue.h"
+#include "pokemon_display.h"
+#include "websocket_client.h"
+#include "connection_supervisor.h"
+#include "animation_player.h"
+#include "text_scroller.h"
+#include "telemetry.h"
+#include "log.h"
+
+/**
+ * Dual-core task split
+ *
+ * The network task (core 0, next to the WiFi stack) services the WebSocket,
+ * falls back to polling /info when the server does not push info, and
+ * decodes every message into a RenderFrame. Between passes it sleeps until
+ * socket data, a wake-up or its next deadline (event_loop.h), never on a
+ * fixed period. The render task (core 1) owns the display: it drains
+ * renderQueue, draws and flushes. The two only share the lock-free SPSC
+ * queue, so a slow I2C flush never delays socket servicing and a long
+ * parse never delays rendering.
+ *
+ * Until startDeviceTasks() is called, the boot sequence plays both roles
+ * from the Arduino loop task.
+ */
+
+#define NETWORK_TASK_CORE 0
+#define RENDER_TASK_CORE 1
+#define NETWORK_TASK_STACK 8192
+#define RENDER_TASK_STACK 8192
+#define NETWORK_TASK_PRIORITY 2
+#define RENDER_TASK_PRIORITY 1
+
+// System info fetch interval when the server does not push info (in milliseconds)
+#define INFO_FETCH_INTERVAL 30000  // Fetch every 30 seconds
+
+// Heap statistics log interval (in milliseconds)
+#define HEAP_REPORT_INTERVAL 60000
+
+TaskHandle_t networkTaskHandle = nullptr;
+unsigned long lastInfoFetch = 0;
+unsigned long lastHeapReport = 0;
+unsigned long lastMetricsReport = 0;
+
+// Set once a message from the server has been drawn, so that boot screens stop drawing over it
+bool serverFrameShown = false;
+
+// Kind of the last full screen drawn (render side), so info patches only land on the info screen
+RenderKind shownKind = RENDER_STATUS;
+
+/**
+ * Draws up to three centered status lines (separated by '\n')
+ * @param display Reference to the NamiDisplay object
+ * @param text Status lines
+ * @param length Length of the text in bytes
+ */
+void displayStatus(NamiDisplay& display, const char* text, size_t length) {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  // Same vertical layout as the original status screens
+  static const int layouts[3][3] = {{28}, {20, 35}, {10, 25, 40}};
+  TextLayout layout;
+  int lineCount = max(layoutText(text, length, TEXT_COLUMNS, 3, TEXT_CLIP, layout), 1);
+
+  for (int i = 0; i < layout.count; i++) {
+    drawCenteredLine(display, layouts[lineCount - 1][i], layout.lines[i].text, layout.lines[i].length);
+  }
+
+  display.display();
+}
+
+/**
+ * Draws one decoded frame
+ * @param display Reference to the NamiDisplay object
+ * @param frame Frame taken from the render queue
+ */
+void renderFrame(NamiDisplay& display, const RenderFrame& frame) {
+  const char (*infoLines)[INFO_LINE_LENGTH] = (const char (*)[INFO_LINE_LENGTH])frame.data;
+
+  switch (frame.kind) {
+    case RENDER_BITMAP:
+      if (displayPokemonBitmap(display, frame.id, frame.name, frame.width, frame.height,
+                               frame.data, frame.length, frame.flags)) {
+        setShownBitmap(frame.seq, frame.width, frame.height);
+      } else {
+        // The next delta gets a resync instead of patching the error screen
+        setShownBitmap(0);
+      }
+      serverFrameShown = true;
+      break;
+    case RENDER_TEXT:
+      if (!startTextScroll(display, SCROLL_MESSAGE, (const char*)frame.data, frame.length)) {
+        displayMessage(display, (const char*)frame.data, frame.length);
+      }
+      serverFrameShown = true;
+      break;
+    case RENDER_ASCII_ART:
+      if (!startTextScroll(display, SCROLL_ASCII_ART, (const char*)frame.data, frame.length)) {
+        displayAsciiArt(display, (const char*)frame.data, frame.length);
+      }
+      serverFrameShown = true;
+      break;
+    case RENDER_STATUS:
+      displayStatus(display, (const char*)frame.data, frame.length);
+      break;
+    case RENDER_SYSTEM_INFO:
+      displaySystemInfo(display, infoLines);
+      break;
+    case RENDER_ANIMATION:
+      startAnimation(display, frame.id);
+      serverFrameShown = true;
+      break;
+    case RENDER_DELTA:
+      // A delta only patches the bitmap already on screen
+      if (applyPokemonDelta(display, frame)) {
+        serverFrameShown = true;
+      }
+      return;
+    case RENDER_INFO_PATCH:
+      if (shownKind == RENDER_SYSTEM_INFO) {
+        patchSystemInfo(display, infoLines, frame.id);
+      }
+      // A patch never replaces the screen
+      return;
+  }
+  if (frame.kind != RENDER_ANIMATION) {
+    // Any other screen replaces the animation
+    stopAnimation();
+  }
+  if (frame.kind != RENDER_TEXT && frame.kind != RENDER_ASCII_ART) {
+    stopTextScroll();
+  }
+  if (frame.kind != RENDER_BITMAP) {
+    // Nothing on screen can serve as a delta base any more
+    setShownBitmap(0);
+  }
+  shownKind = frame.kind;
+}
+
+/**
+ * Draws every frame waiting in the render queue
+ * Must only be called from the task currently consuming the queue.
+ * @param display Reference to the NamiDisplay object
+ * @return number of frames drawn
+ */
+int renderPendingFrames(NamiDisplay& display) {
+  int rendered = 0;
+  bool fromServer = false;
+  RenderFrame* frame;
+  while ((frame = renderQueue.front()) != nullptr) {
+    uint32_t dequeuedAt = micros();
+    renderFrame(display, *frame);
+    recordFrameTiming(display, *frame, dequeuedAt);
+    fromServer |= frame->receivedAt != 0;
+    renderQueue.pop();
+    rendered++;
+  }
+  if (fromServer) {
+    // Frame and trace acks are due
+    wakeNetworkTask();
+  }
+  return rendered;
+}
+
+/**
+ * Render task: sleeps until the network task publishes a frame, or the next
+ * animation frame or scroll step is due
+ */
+void renderTask(void* parameter) {
+  NamiDisplay& display = *(NamiDisplay*)parameter;
+  for (;;) {
+    renderPendingFrames(display);
+    uint32_t wait = min(serviceAnimation(display), serviceTextScroll(display));
+    // Notifications given while drawing are counted, so none is lost
+    ulTaskNotifyTake(pdTRUE, wait == portMAX_DELAY ? portMAX_DELAY : pdMS_TO_TICKS(wait));
+  }
+}
+
+/**
+ * Logs heap statistics, to check that heap use stays flat over long runs
+ * A shrinking largest free block with steady free heap means fragmentation.
+ */
+void reportHeap() {
+  LOG_INFO("Heap", "Free %u, min free %u, largest block %u, arena peak %u/%u, arena failures %u",
+           (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap(),
+           (unsigned)messageArena.highWater(), (unsigned)MESSAGE_ARENA_CAPACITY, (unsigned)messageArena.failures());
+}
+
+/**
+ * Sends the telemetry window and gauges as a metrics message
+ * Stage arrays are [p50, p95, max] in microseconds, heap is [free, min free,
+ * largest block] and stack is the high-water mark (bytes never used) of
+ * the network and render tasks. recover_ms is [last, worst] time from a
+ * lost connection to an open WebSocket (see connection_supervisor.h).
+ * @return true if the message was sent
+ */
+bool sendMetrics() {
+  StageSummary stages[STAGE_COUNT];
+  uint32_t dropped = telemetryRing.dropped();
+  int count = drainTelemetry(stages);
+
+  const StageSummary& parse = stages[STAGE_PARSE];
+  const StageSummary& queue = stages[STAGE_QUEUE];
+  const StageSummary& render = stages[STAGE_RENDER];
+  const StageSummary& flush = stages[STAGE_FLUSH];
+  const StageSummary& total = stages[STAGE_TOTAL];
+  bool sent = sendTextMessage(
+    "{\"type\":\"metrics\",\"uptime\":%lu,\"frames\":%d,\"dropped\":%u,"
+    "\"parse_us\":[%u,%u,%u],\"queue_us\":[%u,%u,%u],\"render_us\":[%u,%u,%u],"
+    "\"flush_us\":[%u,%u,%u],\"total_us\":[%u,%u,%u],"
+    "\"heap\":[%u,%u,%u],\"stack\":[%u,%u],\"reconnects\":%u,\"disconnects\":%u,"
+    "\"outages\":%u,\"recover_ms\":[%u,%u],\"rssi\":%d}",
+    (unsigned long)(millis() / 1000), count, (unsigned)dropped,
+    parse.p50, parse.p95, parse.max, queue.p50, queue.p95, queue.max,
+    render.p50, render.p95, render.max, flush.p50, flush.p95, flush.max,
+    total.p50, total.p95, total.max,
+    (unsigned)ESP.getFreeHeap(), (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap(),
+    (unsigned)uxTaskGetStackHighWaterMark(networkTaskHandle),
+    (unsigned)uxTaskGetStackHighWaterMark(renderTaskHandle),
+    (unsigned)(webSocketConnects > 0 ? webSocketConnects - 1 : 0), (unsigned)webSocketDisconnects,
+    (unsigned)supervisor.outages, (unsigned)supervisor.lastRecovery, (unsigned)supervisor.worstRecovery,
+    (int)WiFi.RSSI());
+  messageArena.reset();
+  return sent;
+}
+
+/**
+ * Network task: WebSocket servicing and periodic system info
+ */
+void networkTask(void* parameter) {
+  (void)parameter;
+  for (;;) {
+    // WiFi, WebSocket and reconnects after a drop
+    uint32_t wait = superviseConnection();
+
+    // The /info request runs in the background; only its result is handled here
+    pollSystemInfo();
+
+    // Poll /info only while the server is not pushing info updates
+    unsigned long currentTime = millis();
+    if (!infoStreamActive && currentTime - lastInfoFetch >= INFO_FETCH_INTERVAL) {
+      requestSystemInfo();
+      lastInfoFetch = currentTime;
+    }
+
+    if (currentTime - lastHeapReport >= HEAP_REPORT_INTERVAL) {
+      reportHeap();
+      lastHeapReport = currentTime;
+    }
+
+    if (currentTime - lastMetricsReport >= TELEMETRY_REPORT_INTERVAL && webSocket.isConnected()) {
+      if (!sendMetrics()) {
+        LOG_WARN("Metrics", "Metrics report dropped");
+      }
+      lastMetricsReport = currentTime;
+    }
+
+    // Sleep until the earliest deadline, or until something happens
+    currentTime = millis();
+    if (!infoStreamActive) {
+      wait = min(wait, timeUntilDue(lastInfoFetch, INFO_FETCH_INTERVAL, currentTime));
+    }
+    if (infoRequest.running()) {
+      wait = min(wait, infoRequest.timeLeft());
+    }
+    wait = min(wait, timeUntilDue(lastHeapReport, HEAP_REPORT_INTERVAL, currentTime));
+    if (webSocket.isConnected()) {
+      wait = min(wait, timeUntilDue(lastMetricsReport, TELEMETRY_REPORT_INTERVAL, currentTime));
+    }
+    waitForEvents(webSocket.fd(), wait);
+  }
+}
+
+/**
+ * Hands the display and the WebSocket over to the pinned tasks
+ * Call once, from the task that ran the boot sequence, which must stop
+ * using both afterwards.
+ * @param display Reference to the NamiDisplay object
+ */
+void startDeviceTasks(NamiDisplay& display) {
+  lastInfoFetch = millis();
+  lastHeapReport = lastInfoFetch;
+  lastMetricsReport = lastInfoFetch;
+  reportHeap();
+
+  xTaskCreatePinnedToCore(renderTask, "render", RENDER_TASK_STACK, &display,
+                          RENDER_TASK_PRIORITY, &renderTaskHandle, RENDER_TASK_CORE);
+  xTaskCreatePinnedToCore(networkTask, "network", NETWORK_TASK_STACK, nullptr,
+                          NETWORK_TASK_PRIORITY, &networkTaskHandle, NETWORK_TASK_CORE);
+
+  LOG_INFO("Tasks", "Network task on core 0, render task on core 1");
+}
+
+#endif // DEVICE_TASKS_H
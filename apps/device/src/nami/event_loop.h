@@ -0,0 +1,137 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#include <Arduino.h>
+#include <sys/select.h>
+#include <unistd.h>
+#include "esp_vfs_eventfd.h"
+#include "log.h"
+
+#if defined(CONFIG_PM_ENABLE) && defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+#include "esp_pm.h"
+#endif
+
+/**
+ * Tickless network loop
+ *
+ * The task that owns the WebSocket (the loop task during boot, then the
+ * network task) does not poll on a fixed period. It sleeps in select() on
+ * the WebSocket's socket and on an eventfd, with a timeout set to its next
+ * deadline (backoff, handshake timeout, info refresh, metrics...). It wakes
+ * up when:
+ *   - the server sends something (socket readable)
+ *   - another task calls wakeNetworkTask(): WiFi events, the render task
+ *     after drawing a server frame (acks to send), the AsyncTCP task when
+ *     an /info response is complete
+ *   - the deadline expires
+ * So a message is handled as soon as it arrives, and an idle device has
+ * nothing runnable for seconds at a time.
+ *
+ * With nothing runnable, FreeRTOS idles, and with automatic light sleep
+ * enabled (needs CONFIG_PM_ENABLE and CONFIG_FREERTOS_USE_TICKLESS_IDLE in
+ * the SDK configuration, see beginEventLoop()) the CPU sleeps until the
+ * next timer or WiFi wake-up. WiFi stays in modem sleep either way, so
+ * incoming frames keep arriving at the AP's beacon (DTIM) cadence.
+ */
+
+#ifndef NAMI_LIGHT_SLEEP
+#define NAMI_LIGHT_SLEEP 1
+#endif
+
+#define EVENT_LOOP_MAX_CPU_MHZ 240
+#define EVENT_LOOP_MIN_CPU_MHZ 80  // Lowest frequency that keeps WiFi running
+
+// Written by any task to wake the network loop
+int wakeFd = -1;
+
+/**
+ * Sets up the wake-up eventfd and, where the SDK supports it, automatic
+ * light sleep
+ * Call once, before any task may call wakeNetworkTask().
+ */
+void beginEventLoop() {
+  esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+  if (esp_vfs_eventfd_register(&config) == ESP_OK) {
+    wakeFd = eventfd(0, 0);
+  }
+  if (wakeFd < 0) {
+    LOG_WARN("Loop", "No eventfd, falling back to timed wake-ups");
+  }
+
+#if NAMI_LIGHT_SLEEP && defined(CONFIG_PM_ENABLE) && defined(CONFIG_FREERTOS_USE_TICKLESS_IDLE)
+#if ESP_IDF_VERSION_MAJOR >= 5
+  esp_pm_config_t pm = {};
+#else
+  esp_pm_config_esp32_t pm = {};
+#endif
+  pm.max_freq_mhz = EVENT_LOOP_MAX_CPU_MHZ;
+  pm.min_freq_mhz = EVENT_LOOP_MIN_CPU_MHZ;
+  pm.light_sleep_enable = true;
+  if (esp_pm_configure(&pm) == ESP_OK) {
+    LOG_INFO("Loop", "Automatic light sleep enabled");
+  } else {
+    LOG_WARN("Loop", "Automatic light sleep not available");
+  }
+#elif NAMI_LIGHT_SLEEP
+  LOG_INFO("Loop", "Automatic light sleep not in this SDK build");
+#endif
+}
+
+/**
+ * Wakes the network loop from any task
+ * Wake-ups given while the loop is busy are kept, so none is lost.
+ */
+void wakeNetworkTask() {
+  if (wakeFd >= 0) {
+    uint64_t one = 1;
+    write(wakeFd, &one, sizeof(one));
+  }
+}
+
+/**
+ * Sleeps until the socket is readable, a wake-up is given or the timeout
+ * expires, whichever comes first
+ * @param socketFd WebSocket socket, or -1 if there is none
+ * @param timeoutMs Longest sleep in milliseconds
+ */
+void waitForEvents(int socketFd, uint32_t timeoutMs) {
+  if (timeoutMs == 0) {
+    return;
+  }
+
+  fd_set readable;
+  FD_ZERO(&readable);
+  int maxFd = -1;
+  if (wakeFd >= 0) {
+    FD_SET(wakeFd, &readable);
+    maxFd = wakeFd;
+  }
+  if (socketFd >= 0) {
+    FD_SET(socketFd, &readable);
+    maxFd = max(maxFd, socketFd);
+  }
+  if (maxFd < 0) {
+    vTaskDelay(pdMS_TO_TICKS(timeoutMs));
+    return;
+  }
+
+  timeval timeout;
+  timeout.tv_sec = timeoutMs / 1000;
+  timeout.tv_usec = (timeoutMs % 1000) * 1000;
+  if (select(maxFd + 1, &readable, nullptr, nullptr, &timeout) > 0 &&
+      wakeFd >= 0 && FD_ISSET(wakeFd, &readable)) {
+    // Consume the wake-ups (the counter resets to 0)
+    uint64_t count;
+    read(wakeFd, &count, sizeof(count));
+  }
+}
+
+/**
+ * @return milliseconds until a periodic job is due, 0 if it is due now
+ */
+inline uint32_t timeUntilDue(unsigned long last, unsigned long interval, unsigned long now) {
+  unsigned long elapsed = now - last;
+  return elapsed >= interval ? 0 : interval - elapsed;
+}
+
+#endif // EVENT_LOOP_H
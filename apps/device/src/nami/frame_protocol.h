@@ -0,0 +1,132 @@
+#ifndef FRAME_PROTOCOL_H
+#define FRAME_PROTOCOL_H
+
+#include <Arduino.h>
+
+/**
+ * Binary WebSocket frame protocol
+ *
+ * Every binary message sent by the server starts with a fixed 12 byte header,
+ * followed by the Pokemon name (nameLength bytes, not null terminated) and the
+ * 1bpp payload (row-major, MSB first, each row padded to (width + 7) / 8
+ * bytes), PackBits compressed when FRAME_FLAG_RLE is set:
+ *
+ *   offset  size  field
+ *   0       1     version     (NAMI_FRAME_VERSION)
+ *   1       1     type        (NamiFrameType)
+ *   2       1     flags       (NamiFrameFlags)
+ *   3       1     nameLength
+ *   4       2     id          (little endian)
+ *   6       1     width       (pixels)
+ *   7       1     height      (pixels)
+ *   8       2     seq         (little endian, 0 = not tracked)
+ *   10      2     baseSeq     (FRAME_TYPE_DELTA only: frame the patch applies to)
+ *
+ * The server numbers the frames it sends to each device. The device answers
+ * {"type":"frame_ack","seq":N} when the bitmap with that seq is on screen
+ * (seq 0 once something else replaced it), so the server knows which frame
+ * it can send a delta against. A delta whose base is no longer shown is
+ * answered with {"type":"frame_resync","seq":N} and the server resends the
+ * full frame.
+ *
+ * Version 1 frames (8 byte header, no seq) are still decoded, so sprites
+ * cached in flash by older firmware remain valid.
+ *
+ * The same layout is produced by apps/server/src/device/protocol.ts.
+ */
+
+#define NAMI_FRAME_VERSION 2
+#define NAMI_FRAME_HEADER_SIZE 12
+#define NAMI_FRAME_V1_HEADER_SIZE 8
+
+enum NamiFrameType : uint8_t {
+  FRAME_TYPE_BITMAP = 0x01,
+  FRAME_TYPE_SHOW_CACHED = 0x02,  // Header only: show sprite "id" from the flash cache
+  FRAME_TYPE_ANIMATION = 0x03,    // Multi-frame sprite, see animation_player.h
+  FRAME_TYPE_DELTA = 0x04,        // XOR patch against bitmap baseSeq, same size
+};
+
+enum NamiFrameFlags : uint8_t {
+  FRAME_FLAG_RLE = 0x01,  // Payload is PackBits compressed (sprite_codec.h)
+  FRAME_FLAG_XOR = 0x02,  // Animation frames after the first are XOR patches against the previous one
+};
+
+struct NamiFrame {
+  uint8_t version;
+  uint8_t type;
+  uint8_t flags;
+  uint16_t id;
+  uint8_t width;
+  uint8_t height;
+  uint16_t seq;
+  uint16_t baseSeq;
+  const char* name;        // Points into the received payload
+  uint8_t nameLength;
+  const uint8_t* data;     // Points into the received payload
+  size_t dataLength;
+};
+
+/**
+ * Decodes a binary frame in place. No bytes are copied: name and data point
+ * straight into the payload buffer, which must outlive the returned frame.
+ * @param payload Raw WebSocket binary payload
+ * @param length Payload length in bytes
+ * @param frame Output frame descriptor
+ * @return true if the header is valid and the payload is large enough
+ */
+bool decodeFrame(const uint8_t* payload, size_t length, NamiFrame& frame) {
+  if (payload == nullptr || length < NAMI_FRAME_V1_HEADER_SIZE) {
+    return false;
+  }
+
+  frame.version = payload[0];
+  size_t headerSize;
+  if (frame.version == NAMI_FRAME_VERSION) {
+    headerSize = NAMI_FRAME_HEADER_SIZE;
+  } else if (frame.version == 1) {
+    headerSize = NAMI_FRAME_V1_HEADER_SIZE;
+  } else {
+    return false;
+  }
+  if (length < headerSize) {
+    return false;
+  }
+
+  frame.type = payload[1];
+  frame.flags = payload[2];
+  frame.nameLength = payload[3];
+  frame.id = (uint16_t)payload[4] | ((uint16_t)payload[5] << 8);
+  frame.width = payload[6];
+  frame.height = payload[7];
+  frame.seq = 0;
+  frame.baseSeq = 0;
+  if (headerSize == NAMI_FRAME_HEADER_SIZE) {
+    frame.seq = (uint16_t)payload[8] | ((uint16_t)payload[9] << 8);
+    frame.baseSeq = (uint16_t)payload[10] | ((uint16_t)payload[11] << 8);
+  }
+
+  size_t offset = headerSize;
+  if (length < offset + frame.nameLength) {
+    return false;
+  }
+  frame.name = (const char*)(payload + offset);
+  offset += frame.nameLength;
+
+  frame.data = payload + offset;
+  frame.dataLength = length - offset;
+
+  if (frame.type == FRAME_TYPE_BITMAP || frame.type == FRAME_TYPE_DELTA) {
+    if (frame.width == 0 || frame.height == 0) {
+      return false;
+    }
+    // Compressed payloads are validated while they are decoded
+    size_t expected = (size_t)((frame.width + 7) / 8) * frame.height;
+    if (!(frame.flags & FRAME_FLAG_RLE) && frame.dataLength < expected) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+#endif // FRAME_PROTOCOL_H
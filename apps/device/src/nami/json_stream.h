@@ -0,0 +1,260 @@
+#ifndef JSON_STREAM_H
+#define JSON_STREAM_H
+
+#include <Arduino.h>
+#include <limits.h>
+
+/**
+ * Streaming JSON reader with bounded memory
+ *
+ * Walks a JSON payload token by token, straight from the receive buffer,
+ * without building a document. Callers pull the keys and values they care
+ * about and skip everything else, so memory use is a few pointers no matter
+ * how large the payload is. Values are skipped iteratively (no recursion),
+ * so deeply nested input cannot overflow the stack either.
+ */
+class JsonStream {
+public:
+  JsonStream(const char* json, size_t length)
+    : pos(json), end(json + length), failed(false) {}
+
+  /**
+   * @return true once a syntax error or truncated input has been seen
+   */
+  bool error() const {
+    return failed;
+  }
+
+  /**
+   * @return the next non-whitespace character without consuming it, or 0 at the end
+   */
+  char peek() {
+    skipWhitespace();
+    return pos < end ? *pos : 0;
+  }
+
+  /**
+   * Consumes the opening brace of an object
+   */
+  bool beginObject() {
+    return expect('{');
+  }
+
+  /**
+   * Reads the next key of the current object and the following colon
+   * @param key Output buffer for the key (truncated to keySize - 1 chars)
+   * @param keySize Size of the key buffer
+   * @return false when the object is closed (or on error)
+   */
+  bool nextKey(char* key, size_t keySize) {
+    if (!nextMember('}')) {
+      return false;
+    }
+    return readString(key, keySize) && expect(':');
+  }
+
+  /**
+   * Consumes the opening bracket of an array
+   */
+  bool beginArray() {
+    return expect('[');
+  }
+
+  /**
+   * Advances to the next element of the current array
+   * @return false when the array is closed (or on error)
+   */
+  bool nextElement() {
+    return nextMember(']');
+  }
+
+  /**
+   * Reads a string value, decoding escapes
+   * @param out Output buffer (truncated to outSize - 1 chars, always null terminated)
+   * @param outSize Size of the output buffer
+   */
+  bool readString(char* out, size_t outSize) {
+    if (!expect('"')) {
+      return false;
+    }
+
+    size_t written = 0;
+    while (pos < end && *pos != '"') {
+      char c = *pos++;
+      if (c == '\\') {
+        if (pos >= end) {
+          return fail();
+        }
+        char escaped = *pos++;
+        switch (escaped) {
+          case 'n': c = '\n'; break;
+          case 't': c = '\t'; break;
+          case 'r': c = '\r'; break;
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'u':
+            // Only ASCII fits the display font; anything else becomes '?'
+            c = decodeUnicodeEscape();
+            break;
+          default: c = escaped; break;
+        }
+      }
+      if (out && written + 1 < outSize) {
+        out[written++] = c;
+      }
+    }
+
+    if (out && outSize > 0) {
+      out[written] = '\0';
+    }
+    return expect('"');
+  }
+
+  /**
+   * Reads an integer value (fractional digits are dropped)
+   * Numbers that do not fit in a long fail the stream.
+   */
+  bool readInt(long& value) {
+    skipWhitespace();
+    bool negative = false;
+    if (pos < end && *pos == '-') {
+      negative = true;
+      pos++;
+    }
+    if (pos >= end || *pos < '0' || *pos > '9') {
+      return fail();
+    }
+
+    long result = 0;
+    while (pos < end && *pos >= '0' && *pos <= '9') {
+      int digit = *pos++ - '0';
+      if (result > (LONG_MAX - digit) / 10) {
+        return fail();
+      }
+      result = result * 10 + digit;
+    }
+    // Skip fraction and exponent
+    while (pos < end && (*pos == '.' || *pos == 'e' || *pos == 'E' || *pos == '+' || *pos == '-' ||
+                         (*pos >= '0' && *pos <= '9'))) {
+      pos++;
+    }
+
+    value = negative ? -result : result;
+    return true;
+  }
+
+  /**
+   * Skips one value of any type, including nested objects and arrays
+   */
+  bool skipValue() {
+    skipWhitespace();
+    int nesting = 0;
+    do {
+      if (pos >= end) {
+        return fail();
+      }
+      char c = *pos;
+      if (c == '"') {
+        if (!readString(nullptr, 0)) {
+          return false;
+        }
+      } else if (c == '{' || c == '[') {
+        nesting++;
+        pos++;
+      } else if (c == '}' || c == ']') {
+        nesting--;
+        pos++;
+      } else {
+        // Literal or number: advance to the next delimiter
+        while (pos < end && *pos != ',' && *pos != '}' && *pos != ']' &&
+               *pos != ' ' && *pos != '\n' && *pos != '\r' && *pos != '\t') {
+          pos++;
+        }
+      }
+      skipWhitespace();
+      if (nesting > 0 && pos < end && (*pos == ',' || *pos == ':')) {
+        pos++;
+        skipWhitespace();
+      }
+    } while (nesting > 0);
+    return !failed;
+  }
+
+private:
+  const char* pos;
+  const char* end;
+  bool failed;
+
+  bool fail() {
+    failed = true;
+    pos = end;
+    return false;
+  }
+
+  void skipWhitespace() {
+    while (pos < end && (*pos == ' ' || *pos == '\n' || *pos == '\r' || *pos == '\t')) {
+      pos++;
+    }
+  }
+
+  bool expect(char c) {
+    skipWhitespace();
+    if (pos >= end || *pos != c) {
+      return fail();
+    }
+    pos++;
+    return true;
+  }
+
+  bool nextMember(char closing) {
+    if (failed) {
+      return false;
+    }
+    skipWhitespace();
+    if (pos < end && *pos == closing) {
+      pos++;
+      return false;
+    }
+    if (pos < end && *pos == ',') {
+      pos++;
+    }
+    skipWhitespace();
+    if (pos >= end) {
+      return fail();
+    }
+    return true;
+  }
+
+  char decodeUnicodeEscape() {
+    unsigned int code = 0;
+    for (int i = 0; i < 4; i++) {
+      if (pos >= end) {
+        fail();
+        return '?';
+      }
+      char h = *pos++;
+      code <<= 4;
+      if (h >= '0' && h <= '9') code |= h - '0';
+      else if (h >= 'a' && h <= 'f') code |= h - 'a' + 10;
+      else if (h >= 'A' && h <= 'F') code |= h - 'A' + 10;
+    }
+    return code < 0x80 ? (char)code : '?';
+  }
+};
+
+/**
+ * Cheap check used to keep plain text messages away from the JSON path
+ * @return true if the first non-whitespace character opens an object
+ */
+inline bool looksLikeJsonObject(const char* text, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    char c = text[i];
+    if (c == ' ' || c == '\n' || c == '\r' || c == '\t') {
+      continue;
+    }
+    return c == '{';
+  }
+  return false;
+}
+
+#endif // JSON_STREAM_H
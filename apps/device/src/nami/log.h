@@ -0,0 +1,229 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdarg.h>
+
+/**
+ * Asynchronous logging
+ *
+ * LOG_ERROR/LOG_WARN/LOG_INFO/LOG_DEBUG("Tag", format, ...) format one
+ * "[Tag] message" line into a fixed-size record and push it into a
+ * lock-free ring; a low-priority task drains the ring to Serial. Logging
+ * costs a vsnprintf of at most LOG_RECORD_SIZE bytes on the calling task,
+ * never the time the UART needs to send the line (about 87 us per byte at
+ * 115200 baud). Lines longer than a record are cut and end with "...";
+ * payloads are logged with logPreviewLength() so only their start is
+ * formatted at all.
+ *
+ * Calls above NAMI_LOG_LEVEL are compiled out, arguments and format
+ * strings included. When the ring is full, records are dropped (never
+ * waited for) and the drain task reports how many.
+ *
+ * Records at or below NAMI_LOG_REMOTE_LEVEL also go to a second ring that
+ * the network task forwards to the server as {"type":"log",...} messages
+ * (sendRemoteLogs() in websocket_client.h). Set it to LOG_LEVEL_NONE to
+ * keep logs local.
+ *
+ * Any task may log, including the WiFi event and AsyncTCP tasks; interrupt
+ * handlers may not.
+ */
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef NAMI_LOG_LEVEL
+#define NAMI_LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#ifndef NAMI_LOG_REMOTE_LEVEL
+#define NAMI_LOG_REMOTE_LEVEL LOG_LEVEL_WARN
+#endif
+
+#define LOG_RECORD_SIZE 128    // One line, tag and NUL included
+#define LOG_RING_DEPTH 32      // Records waiting for the UART
+#define LOG_REMOTE_DEPTH 8     // Records waiting for the WebSocket
+#define LOG_PREVIEW_LENGTH 48  // Payload bytes shown in a log line
+#define LOG_TASK_CORE 0
+#define LOG_TASK_STACK 3072
+#define LOG_TASK_PRIORITY 1    // Below the network task
+
+#define LOG_AT(level, tag, ...)                 \
+  do {                                          \
+    if ((level) <= NAMI_LOG_LEVEL) {            \
+      logWrite((level), (tag), __VA_ARGS__);    \
+    }                                           \
+  } while (0)
+
+#define LOG_ERROR(tag, ...) LOG_AT(LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define LOG_WARN(tag, ...) LOG_AT(LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define LOG_INFO(tag, ...) LOG_AT(LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define LOG_DEBUG(tag, ...) LOG_AT(LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+
+struct LogRecord {
+  uint32_t ms;  // millis() when logged
+  uint8_t level;
+  char text[LOG_RECORD_SIZE];
+};
+
+/**
+ * Bounded multi-producer ring with a single consumer
+ * Each slot carries a sequence number telling whether it is free for the
+ * producer claiming that position or holds a record for the consumer, so
+ * producers only contend on one compare-and-swap and never wait for each
+ * other or for the consumer.
+ */
+template <size_t Depth>
+class LogRing {
+  static_assert(Depth > 0 && (Depth & (Depth - 1)) == 0, "Depth must be a power of two");
+
+public:
+  LogRing() : tail(0), lost(0), head(0) {
+    for (size_t i = 0; i < Depth; i++) {
+      slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Appends a record; any task
+   * @return false if the ring was full and the record was dropped
+   */
+  bool push(const LogRecord& record) {
+    uint32_t pos = tail.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots[pos & (Depth - 1)];
+      int32_t diff = (int32_t)(slot->sequence.load(std::memory_order_acquire) - pos);
+      if (diff == 0) {
+        if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        lost.fetch_add(1, std::memory_order_relaxed);
+        return false;
+      } else {
+        pos = tail.load(std::memory_order_relaxed);
+      }
+    }
+
+    slot->record.ms = record.ms;
+    slot->record.level = record.level;
+    strcpy(slot->record.text, record.text);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Takes the oldest record; consumer task only
+   * @return false if the ring is empty
+   */
+  bool pop(LogRecord& record) {
+    Slot& slot = slots[head & (Depth - 1)];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) {
+      return false;
+    }
+    record = slot.record;
+    slot.sequence.store(head + Depth, std::memory_order_release);
+    head++;
+    return true;
+  }
+
+  /**
+   * @return number of records dropped since boot
+   */
+  uint32_t dropped() const {
+    return lost.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Slot {
+    std::atomic<uint32_t> sequence;
+    LogRecord record;
+  };
+
+  Slot slots[Depth];
+  std::atomic<uint32_t> tail;
+  std::atomic<uint32_t> lost;
+  uint32_t head;
+};
+
+LogRing<LOG_RING_DEPTH> logRing;
+LogRing<LOG_REMOTE_DEPTH> remoteLogRing;
+TaskHandle_t logTaskHandle = nullptr;
+
+static const char* const logLevelNames[] = {"none", "error", "warn", "info", "debug"};
+
+/**
+ * Formats a log line and queues it; use the LOG_* macros instead
+ * @param level LOG_LEVEL_*
+ * @param tag Subsystem, printed as "[tag] "
+ * @param format printf-style format
+ */
+void logWrite(uint8_t level, const char* tag, const char* format, ...) __attribute__((format(printf, 3, 4)));
+void logWrite(uint8_t level, const char* tag, const char* format, ...) {
+  LogRecord record;
+  record.ms = millis();
+  record.level = level;
+
+  int prefix = snprintf(record.text, sizeof(record.text), "[%s] ", tag);
+  prefix = min(max(prefix, 0), (int)sizeof(record.text) - 1);
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(record.text + prefix, sizeof(record.text) - prefix, format, args);
+  va_end(args);
+  if (n >= (int)sizeof(record.text) - prefix) {
+    // Mark lines that did not fit
+    memcpy(record.text + sizeof(record.text) - 4, "...", 4);
+  }
+
+  logRing.push(record);
+  if (level <= NAMI_LOG_REMOTE_LEVEL) {
+    remoteLogRing.push(record);
+  }
+  if (logTaskHandle != nullptr) {
+    xTaskNotifyGive(logTaskHandle);
+  }
+}
+
+/**
+ * @return number of payload bytes to show in a log line ("%.*s")
+ */
+inline int logPreviewLength(size_t length) {
+  return (int)min(length, (size_t)LOG_PREVIEW_LENGTH);
+}
+
+/**
+ * Log task: writes queued records to Serial, then sleeps until the next one
+ */
+void logTask(void* parameter) {
+  (void)parameter;
+  LogRecord record;
+  uint32_t reportedLost = 0;
+  for (;;) {
+    while (logRing.pop(record)) {
+      Serial.println(record.text);
+    }
+    uint32_t lost = logRing.dropped();
+    if (lost != reportedLost) {
+      Serial.print("[Log] ");
+      Serial.print(lost - reportedLost);
+      Serial.println(" lines dropped");
+      reportedLost = lost;
+    }
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+
+/**
+ * Starts the log task
+ * Call once, after Serial.begin(). Lines logged before are kept (up to
+ * LOG_RING_DEPTH) and printed once it runs.
+ */
+void beginLog() {
+  xTaskCreatePinnedToCore(logTask, "log", LOG_TASK_STACK, nullptr, LOG_TASK_PRIORITY, &logTaskHandle, LOG_TASK_CORE);
+}
+
+#endif // LOG_H
@@ -0,0 +1,74 @@
+#ifndef MESSAGE_ARENA_H
+#define MESSAGE_ARENA_H
+
+#include <Arduino.h>
+
+/**
+ * Per-message scratch memory for the network task
+ *
+ * Handling one WebSocket message (or one round of acknowledgements) often
+ * needs a few temporary buffers whose size depends on the message. Instead
+ * of the heap, they come from a fixed static block: alloc() bumps a
+ * pointer, and reset() releases everything at once after each message.
+ * Nothing is ever freed individually, so the heap is not touched and
+ * cannot fragment, however long the device runs.
+ *
+ * Only the task that owns the WebSocket (the boot loop, then the network
+ * task) may use messageArena. Pointers are invalid after reset().
+ */
+
+#define MESSAGE_ARENA_CAPACITY 1024
+#define MESSAGE_ARENA_ALIGN 4
+
+class MessageArena {
+public:
+  MessageArena() : used(0), peak(0), failed(0) {}
+
+  /**
+   * @param size Number of bytes needed
+   * @return uninitialized memory, or nullptr if the arena is exhausted
+   */
+  void* alloc(size_t size) {
+    size_t start = (used + MESSAGE_ARENA_ALIGN - 1) & ~(size_t)(MESSAGE_ARENA_ALIGN - 1);
+    if (size > MESSAGE_ARENA_CAPACITY || start > MESSAGE_ARENA_CAPACITY - size) {
+      failed++;
+      return nullptr;
+    }
+    used = start + size;
+    if (used > peak) {
+      peak = used;
+    }
+    return buffer + start;
+  }
+
+  /**
+   * Releases every allocation made since the previous reset
+   */
+  void reset() {
+    used = 0;
+  }
+
+  /**
+   * @return largest number of bytes ever in use at once
+   */
+  size_t highWater() const {
+    return peak;
+  }
+
+  /**
+   * @return number of allocations that did not fit
+   */
+  uint32_t failures() const {
+    return failed;
+  }
+
+private:
+  alignas(MESSAGE_ARENA_ALIGN) uint8_t buffer[MESSAGE_ARENA_CAPACITY];
+  size_t used;
+  size_t peak;
+  uint32_t failed;
+};
+
+MessageArena messageArena;
+
+#endif // MESSAGE_ARENA_H
@@ -1,15 +1,19 @@
 #include <Wire.h>
-#include <Adafruit_GFX.h>
-#include <Adafruit_SSD1306.h>
+#include "nami_display.h"
 #include "wifi_connection.h"
 #include "websocket_client.h"
+#include "boot_sequence.h"
+#include "device_tasks.h"
+#ifdef NAMI_BENCH
+#include "bench.h"
+#endif
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 #define OLED_RESET    -1
 #define SCREEN_ADDRESS 0x3C
 
-Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+NamiDisplay display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
 
 // Bitmap data - 40x30px
 const unsigned char epd_bitmap_25 [] PROGMEM = {
@@ -25,20 +29,28 @@ const unsigned char epd_bitmap_25 [] PROGMEM = {
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 };
 
-// System info fetch interval (in milliseconds)
-#define INFO_FETCH_INTERVAL 30000  // Fetch every 30 seconds
-unsigned long lastInfoFetch = 0;
-
 void setup() {
   // Initialize Serial for logging
   Serial.begin(115200);
-  delay(1000);
   Serial.println("\n\n=== Nami ESP32 Starting ===");
+  beginLog();
 
   Wire.begin(21, 22);
   display.begin(SSD1306_SWITCHCAPVCC, SCREEN_ADDRESS);
   display.clearDisplay();
 
+#ifdef NAMI_BENCH
+  // --- Benchmarks ---
+  // Benchmark builds only measure, they never connect
+  runBenchmarks(display);
+  Serial.println("[Bench] Done");
+  vTaskDelete(NULL);
+#endif
+
+  // --- Display Flushes ---
+  // From here on frames go out on the bus while the next one is drawn
+  display.startFlushTask();
+
   // --- Startup Display ---
   // Display "nami" text centered and enlarged with bitmap
   display.setTextSize(2); // Enlarged text
@@ -54,121 +66,23 @@ void setup() {
   int xBitmap = (SCREEN_WIDTH - 40) / 2;
   display.drawXBitmap(xBitmap, 30, epd_bitmap_25, 40, 30, SSD1306_WHITE);
   display.display();
-  
-  // 2 second delay
-  delay(2000);
-
-  // --- Setup Animation ---
-  // Display "setting up your nami" with animated dots for 5 seconds
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-  
-  String setupText = "setting up your nami";
-  int xSetup = centerText(display, setupText, 0);
-  display.setCursor(xSetup, 25);
-  display.print(setupText);
-  
-  unsigned long setupStartTime = millis();
-  const unsigned long setupDuration = 5000; // 5 seconds
-  int dotCount = 0;
-  
-  while (millis() - setupStartTime < setupDuration) {
-    // Clear dots area
-    display.fillRect(0, 35, SCREEN_WIDTH, 10, SSD1306_BLACK);
-    
-    // Display dots (one at a time, looping through 3)
-    String dots = "";
-    for (int i = 0; i < dotCount; i++) {
-      dots += ".";
-    }
-    
-    int xDots = centerText(display, dots, 0);
-    display.setCursor(xDots, 35);
-    display.print(dots);
-    display.display();
-    
-    // Update dot count (0, 1, 2, then back to 0)
-    delay(500); // Change dot every 500ms
-    dotCount = (dotCount + 1) % 3;
-  }
-  
-  // Clear display before WiFi connection
-  display.clearDisplay();
-  display.display();
-  delay(200);
-
-  // --- WiFi Connection ---
-  // Connect to WiFi and display status on screen
-  bool wifiConnected = connectToWiFi(display);
-  
-  // Only proceed with other logic after WiFi connection succeeds
-  if (!wifiConnected) {
-    // If connection failed, retry once more
-    delay(1000);
-    wifiConnected = connectToWiFi(display);
-  }
-
-  // Wait for WiFi connection before proceeding
-  // If still not connected, show error and wait
-  if (!wifiConnected) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    int x1 = centerText(display, "WiFi Failed", 0);
-    display.setCursor(x1, 10);
-    display.println("WiFi Failed");
-    
-    int x2 = centerText(display, "Check config", 0);
-    display.setCursor(x2, 25);
-    display.println("Check config");
-    
-    int x3 = centerText(display, "Restarting...", 0);
-    display.setCursor(x3, 40);
-    display.println("Restarting...");
-    display.display();
-    delay(3000);
-    ESP.restart(); // Restart ESP32 to retry connection
-    return;
-  }
-
-  // Clear display after successful WiFi connection
-  display.clearDisplay();
-  display.display();
-  delay(500);
-
-  // --- WebSocket Connection ---
-  Serial.println("[Setup] Connecting to WebSocket...");
-  bool wsConnected = connectWebSocket(display);
-  if (wsConnected) {
-    Serial.println("[Setup] WebSocket connection succeeded!");
-  } else {
-    Serial.println("[Setup] WebSocket connection failed!");
-  }
-
-  delay(1000);
 
-  // --- Fetch System Info ---
-  Serial.println("[Setup] Fetching system info from /info endpoint...");
-  fetchAndDisplaySystemInfo(display);
-  lastInfoFetch = millis();
+  // --- Boot Sequence ---
+  // WiFi, WebSocket and the setup animation run concurrently from loop()
+  bootBegin(display);
 }
 
 void loop() {
-  // --- Maintain WebSocket Connection ---
-  maintainWebSocket();
-
-  // --- System Info Fetching ---
-  unsigned long currentTime = millis();
-  
-  // Check if it's time to fetch new data
-  if (currentTime - lastInfoFetch >= INFO_FETCH_INTERVAL) {
-    fetchAndDisplaySystemInfo(display);
-    lastInfoFetch = currentTime;
+  // --- Boot Sequence ---
+  if (!bootStep(display)) {
+    // Sleeps until the next boot step is due, a WiFi event or server data
+    waitForEvents(webSocket.fd(), bootWaitTime());
+    return;
   }
-  
-  // Small delay to prevent excessive CPU usage
-  delay(100);
-}
 
+  // --- Dual-Core Tasks ---
+  // From here on the network task (core 0) owns the WebSocket and the
+  // render task (core 1) owns the display; the loop task is not needed
+  startDeviceTasks(display);
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,509 @@
+#ifndef NAMI_DISPLAY_H
+#define NAMI_DISPLAY_H
+
+#include <Wire.h>
+#include <Adafruit_GFX.h>
+#include <Adafruit_SSD1306.h>
+#include <atomic>
+#include "esp_idf_version.h"
+
+// Largest framebuffer supported by the shadow copy (128x64 at 1 bit per pixel)
+#define NAMI_DISPLAY_MAX_BYTES (128 * 64 / 8)
+#define NAMI_DISPLAY_MAX_PAGES (64 / 8)
+
+// Bytes per I2C transaction, including the 0x40 data control byte
+#ifdef I2C_BUFFER_LENGTH
+#define NAMI_DISPLAY_I2C_CHUNK I2C_BUFFER_LENGTH
+#else
+#define NAMI_DISPLAY_I2C_CHUNK 32
+#endif
+
+// I2C clock while flushing. The SSD1306 datasheet stops at 400 kHz, most
+// modules also run at 1 MHz: -DNAMI_DISPLAY_I2C_HZ=1000000
+#ifndef NAMI_DISPLAY_I2C_HZ
+#define NAMI_DISPLAY_I2C_HZ 400000UL
+#endif
+
+// Send each flush as one ESP-IDF command link (1) or through Wire (0).
+// From IDF 5.4 the Arduino core puts Wire on the new i2c_master driver,
+// which cannot be mixed with the legacy one the command links belong to.
+#ifndef NAMI_DISPLAY_I2C_LINK
+#if ESP_IDF_VERSION < ESP_IDF_VERSION_VAL(5, 4, 0)
+#define NAMI_DISPLAY_I2C_LINK 1
+#else
+#define NAMI_DISPLAY_I2C_LINK 0
+#endif
+#endif
+
+#if NAMI_DISPLAY_I2C_LINK
+#include "driver/i2c.h"
+#define NAMI_DISPLAY_I2C_PORT I2C_NUM_0  // The port Wire uses
+#define NAMI_DISPLAY_I2C_TIMEOUT 100     // Whole flush (ms); a full frame takes 25 ms at 400 kHz
+#endif
+
+#define DISPLAY_FLUSH_TASK_CORE 0
+#define DISPLAY_FLUSH_TASK_STACK 2048
+#define DISPLAY_FLUSH_TASK_PRIORITY 3  // Above the network task, so the bus never waits for it
+
+/**
+ * One flush, ready to go out on the bus
+ * The changed bytes are copied out of the framebuffer, so drawing can go
+ * on while they are sent. Control bytes are stored with them, so each
+ * window is two plain writes.
+ */
+struct DisplayFlush {
+  struct Window {
+    uint8_t command[7];  // 0x00, page and column address commands
+    uint16_t offset;     // 0x40 then the window's bytes, in data
+    uint16_t length;     // Window bytes, control byte not included
+  };
+  Window windows[NAMI_DISPLAY_MAX_PAGES];
+  uint8_t windowCount;
+  uint8_t startLine[2];  // 0x00, start line command
+  bool sendStartLine;
+  uint8_t data[NAMI_DISPLAY_MAX_BYTES + NAMI_DISPLAY_MAX_PAGES];
+};
+
+/**
+ * SSD1306 display with dirty-page tracking and partial I2C flushes
+ *
+ * Every drawing primitive records the page and column range it touched.
+ * display() then sends only those windows, using the controller's
+ * column/page address commands, instead of the full 1 KB framebuffer.
+ * A shadow copy of what the panel currently shows trims each window down
+ * to the bytes that really changed, so the usual clear-and-redraw pattern
+ * costs only the difference on the bus.
+ *
+ * Code writing straight into getBuffer() must call markDirty() itself.
+ *
+ * beginFrame()/presentFrame() bracket a frame composed in a back buffer:
+ * display() calls made by drawing helpers in between are deferred, and the
+ * completed front buffer is never drawn into, so a flush always sends a
+ * whole frame.
+ *
+ * setStartLine() moves the controller's display start line, which rotates
+ * the 64 RAM rows on screen (hardware vertical scrolling). The change is
+ * sent by the next display(), after the pixel data. clearDisplay() moves
+ * the start line back to 0, so a new screen always appears unrotated.
+ *
+ * Once startFlushTask() ran, display() only snapshots the changed windows
+ * and hands them to a flush task, which sends them while the caller goes
+ * on drawing. Snapshots alternate between two buffers: display() waits
+ * only when the previous flush is still on the bus (about 25 ms for a
+ * full frame at 400 kHz, 10 ms at 1 MHz). waitForFlush() waits until the
+ * panel shows everything flushed so far. The flush task is the only one
+ * using the bus from then on.
+ */
+class NamiDisplay : public Adafruit_SSD1306 {
+public:
+  NamiDisplay(uint8_t w, uint8_t h, TwoWire* twi = &Wire, int8_t rst_pin = -1,
+              uint32_t clkDuring = NAMI_DISPLAY_I2C_HZ, uint32_t clkAfter = 100000UL)
+    : Adafruit_SSD1306(w, h, twi, rst_pin, clkDuring, clkAfter), shadowValid(false), bytesFlushed(0),
+      lastFlushAt(0), spareBuffer(nullptr), frameOpen(false), startLine(0), panelStartLine(0),
+      nextFlush(0), pendingFlush(nullptr), flushTask(nullptr), flushIdle(nullptr), flushFailed(false) {
+    clearDirty();
+  }
+
+  ~NamiDisplay() {
+    free(spareBuffer);
+  }
+
+  bool begin(uint8_t switchvcc = SSD1306_SWITCHCAPVCC, uint8_t i2caddr = 0,
+             bool reset = true, bool periphBegin = true) {
+    waitForFlush();
+    bool ok = Adafruit_SSD1306::begin(switchvcc, i2caddr, reset, periphBegin);
+    // The panel content is unknown until the first full flush
+    shadowValid = false;
+    markAllDirty();
+    // The init sequence sets the start line to 0
+    startLine = 0;
+    panelStartLine = 0;
+    return ok;
+  }
+
+  void clearDisplay() {
+    Adafruit_SSD1306::clearDisplay();
+    markAllDirty();
+    startLine = 0;
+  }
+
+  /**
+   * Sets which RAM row is shown at the top of the screen
+   * Takes effect with the next display().
+   * @param line RAM row, wrapped to the display height
+   */
+  void setStartLine(uint8_t line) {
+    startLine = line % HEIGHT;
+  }
+
+  /**
+   * @return RAM row shown at the top of the screen after the next display()
+   */
+  uint8_t getStartLine() const {
+    return startLine;
+  }
+
+  void drawPixel(int16_t x, int16_t y, uint16_t color) override {
+    Adafruit_SSD1306::drawPixel(x, y, color);
+    markDirty(x, y, 1, 1);
+  }
+
+  void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) override {
+    Adafruit_SSD1306::drawFastHLine(x, y, w, color);
+    markDirty(x, y, w, 1);
+  }
+
+  void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) override {
+    Adafruit_SSD1306::drawFastVLine(x, y, h, color);
+    markDirty(x, y, 1, h);
+  }
+
+  /**
+   * Records that a rectangle of the framebuffer was modified
+   * Coordinates are in the current rotation; anything but rotation 0
+   * conservatively marks the whole screen.
+   * @param x Left edge in pixels
+   * @param y Top edge in pixels
+   * @param w Width in pixels
+   * @param h Height in pixels
+   */
+  void markDirty(int x, int y, int w, int h) {
+    if (getRotation() != 0) {
+      markAllDirty();
+      return;
+    }
+
+    int x0 = max(x, 0);
+    int x1 = min(x + w - 1, (int)WIDTH - 1);
+    int y0 = max(y, 0);
+    int y1 = min(y + h - 1, (int)HEIGHT - 1);
+    if (x0 > x1 || y0 > y1) {
+      return;
+    }
+
+    for (int page = y0 / 8; page <= y1 / 8; page++) {
+      if (x0 < dirtyMin[page]) dirtyMin[page] = x0;
+      if (x1 > dirtyMax[page]) dirtyMax[page] = x1;
+    }
+  }
+
+  /**
+   * Marks the whole framebuffer as modified
+   */
+  void markAllDirty() {
+    for (int page = 0; page < NAMI_DISPLAY_MAX_PAGES; page++) {
+      dirtyMin[page] = 0;
+      dirtyMax[page] = WIDTH - 1;
+    }
+  }
+
+  /**
+   * Starts composing a frame in the back buffer
+   * The back buffer starts as a copy of the current frame, so only what
+   * changes needs to be drawn. Until presentFrame(), display() does nothing.
+   * @return false if the back buffer could not be allocated (drawing then
+   *         goes straight to the front buffer, as without beginFrame())
+   */
+  bool beginFrame() {
+    size_t bufferSize = (size_t)WIDTH * (HEIGHT / 8);
+    if (frameOpen || buffer == nullptr) {
+      return frameOpen;
+    }
+    if (spareBuffer == nullptr) {
+      // Heap allocated like the Adafruit buffer, since the two are swapped
+      spareBuffer = (uint8_t*)malloc(bufferSize);
+      if (spareBuffer == nullptr) {
+        return false;
+      }
+    }
+
+    memcpy(spareBuffer, buffer, bufferSize);
+    uint8_t* front = buffer;
+    buffer = spareBuffer;
+    spareBuffer = front;
+    frameOpen = true;
+    return true;
+  }
+
+  /**
+   * Makes the composed back buffer the front buffer and flushes it
+   */
+  void presentFrame() {
+    // The previous front buffer becomes the next back buffer
+    frameOpen = false;
+    display();
+  }
+
+  /**
+   * Sends the modified parts of the framebuffer to the panel
+   * Falls back to a full transfer for the very first flush, or when the
+   * display is too large for the shadow copy.
+   */
+  void display() {
+    if (frameOpen) {
+      return;
+    }
+    lastFlushAt = micros();
+
+    int pages = HEIGHT / 8;
+    size_t bufferSize = (size_t)WIDTH * pages;
+
+    if (wire == nullptr || bufferSize > sizeof(shadow)) {
+      waitForFlush();
+      Adafruit_SSD1306::display();
+      bytesFlushed += bufferSize;
+      clearDirty();
+      sendStartLine();
+      return;
+    }
+
+    if (flushFailed.exchange(false)) {
+      // The panel may show anything after a failed transfer
+      shadowValid = false;
+      markAllDirty();
+    }
+
+    DisplayFlush& flush = flushes[nextFlush];
+    flush.windowCount = 0;
+    size_t used = 0;
+    for (int page = 0; page < pages; page++) {
+      int first = dirtyMin[page];
+      int last = dirtyMax[page];
+      if (first > last) {
+        continue;
+      }
+
+      // Trim columns that already match what the panel shows
+      const uint8_t* row = buffer + page * WIDTH;
+      const uint8_t* shadowRow = shadow + page * WIDTH;
+      if (shadowValid) {
+        while (first <= last && row[first] == shadowRow[first]) first++;
+        while (last >= first && row[last] == shadowRow[last]) last--;
+        if (first > last) {
+          continue;
+        }
+      }
+
+      int length = last - first + 1;
+      DisplayFlush::Window& window = flush.windows[flush.windowCount++];
+      const uint8_t command[] = {
+        0x00, SSD1306_PAGEADDR, (uint8_t)page, (uint8_t)page,
+        SSD1306_COLUMNADDR, (uint8_t)first, (uint8_t)last,
+      };
+      memcpy(window.command, command, sizeof(command));
+      window.offset = used;
+      window.length = length;
+      flush.data[used] = 0x40;
+      memcpy(flush.data + used + 1, row + first, length);
+      used += length + 1;
+
+      memcpy(shadow + page * WIDTH + first, row + first, length);
+      bytesFlushed += length;
+    }
+    shadowValid = true;
+    clearDirty();
+
+    flush.sendStartLine = startLine != panelStartLine;
+    flush.startLine[0] = 0x00;
+    flush.startLine[1] = SSD1306_SETSTARTLINE | startLine;
+    panelStartLine = startLine;
+
+    if (flush.windowCount > 0 || flush.sendStartLine) {
+      submitFlush(flush);
+    }
+  }
+
+  /**
+   * Starts the flush task; from then on display() returns once the
+   * changed bytes are copied, and the task sends them
+   * Call once, after begin(). Without it, display() sends synchronously.
+   * @return true if the task runs
+   */
+  bool startFlushTask() {
+    if (flushTask != nullptr || wire == nullptr) {
+      return flushTask != nullptr;
+    }
+    flushIdle = xSemaphoreCreateBinary();
+    if (flushIdle == nullptr) {
+      return false;
+    }
+    xSemaphoreGive(flushIdle);
+    TaskHandle_t task = nullptr;
+    if (xTaskCreatePinnedToCore(flushTaskMain, "flush", DISPLAY_FLUSH_TASK_STACK, this,
+                                DISPLAY_FLUSH_TASK_PRIORITY, &task, DISPLAY_FLUSH_TASK_CORE) != pdPASS) {
+      return false;
+    }
+    flushTask = task;
+    return true;
+  }
+
+  /**
+   * Waits until every flush handed to the flush task is on the panel
+   */
+  void waitForFlush() const {
+    if (flushTask != nullptr) {
+      xSemaphoreTake(flushIdle, portMAX_DELAY);
+      xSemaphoreGive(flushIdle);
+    }
+  }
+
+  /**
+   * @return total number of framebuffer bytes sent to the panel since boot
+   */
+  uint32_t flushedBytes() const {
+    return bytesFlushed;
+  }
+
+  /**
+   * @return micros() when the last flush started
+   */
+  uint32_t flushStartedAt() const {
+    return lastFlushAt;
+  }
+
+protected:
+  uint8_t shadow[NAMI_DISPLAY_MAX_BYTES];
+  bool shadowValid;
+  uint8_t dirtyMin[NAMI_DISPLAY_MAX_PAGES];
+  uint8_t dirtyMax[NAMI_DISPLAY_MAX_PAGES];
+  uint32_t bytesFlushed;
+  uint32_t lastFlushAt;
+  uint8_t* spareBuffer;  // Back buffer while a frame is open, previous front otherwise
+  bool frameOpen;
+  uint8_t startLine;       // Start line the next flush leaves on the panel
+  uint8_t panelStartLine;  // Start line the panel uses once queued flushes are sent
+  DisplayFlush flushes[2];  // One being filled while the other may be on the bus
+  uint8_t nextFlush;
+  DisplayFlush* pendingFlush;      // Handed to the flush task
+  TaskHandle_t flushTask;
+  SemaphoreHandle_t flushIdle;     // Given while no flush is pending
+  std::atomic<bool> flushFailed;   // Set by the flush task
+#if NAMI_DISPLAY_I2C_LINK
+  // Command link of one flush: two writes per window, the start line, the stop
+  uint8_t linkBuffer[I2C_LINK_RECOMMENDED_SIZE(NAMI_DISPLAY_MAX_PAGES * 2 + 1)];
+#endif
+
+  void clearDirty() {
+    for (int page = 0; page < NAMI_DISPLAY_MAX_PAGES; page++) {
+      dirtyMin[page] = 0xFF;
+      dirtyMax[page] = 0;
+    }
+  }
+
+  /**
+   * Sends the start line command if it changed since the last flush
+   */
+  void sendStartLine() {
+    if (startLine == panelStartLine || wire == nullptr) {
+      return;
+    }
+    wire->setClock(wireClk);
+    ssd1306_command1(SSD1306_SETSTARTLINE | startLine);
+    wire->setClock(restoreClk);
+    panelStartLine = startLine;
+  }
+
+  /**
+   * Hands a flush to the flush task, or sends it right away without one
+   * Waits while the previous flush is still on the bus.
+   */
+  void submitFlush(DisplayFlush& flush) {
+    if (flushTask == nullptr) {
+      if (!sendFlush(flush)) {
+        flushFailed.store(true);
+      }
+      return;
+    }
+    xSemaphoreTake(flushIdle, portMAX_DELAY);
+    pendingFlush = &flush;
+    nextFlush ^= 1;
+    xTaskNotifyGive(flushTask);
+  }
+
+  /**
+   * Flush task: sends each flush it is handed
+   */
+  static void flushTaskMain(void* parameter) {
+    NamiDisplay* self = (NamiDisplay*)parameter;
+    for (;;) {
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+      if (!self->sendFlush(*self->pendingFlush)) {
+        self->flushFailed.store(true);
+      }
+      xSemaphoreGive(self->flushIdle);
+    }
+  }
+
+#if NAMI_DISPLAY_I2C_LINK
+  /**
+   * Sends a flush as one command link: the driver feeds the I2C FIFO from
+   * its interrupt, so the calling task sleeps for the whole transfer
+   * @return false if the panel did not acknowledge
+   */
+  bool sendFlush(const DisplayFlush& flush) {
+    uint8_t address = (i2caddr << 1) | I2C_MASTER_WRITE;
+    i2c_cmd_handle_t link = i2c_cmd_link_create_static(linkBuffer, sizeof(linkBuffer));
+    if (link == nullptr) {
+      return false;
+    }
+
+    for (int i = 0; i < flush.windowCount; i++) {
+      const DisplayFlush::Window& window = flush.windows[i];
+      i2c_master_start(link);
+      i2c_master_write_byte(link, address, true);
+      i2c_master_write(link, window.command, sizeof(window.command), true);
+      i2c_master_start(link);
+      i2c_master_write_byte(link, address, true);
+      i2c_master_write(link, flush.data + window.offset, window.length + 1, true);
+    }
+    if (flush.sendStartLine) {
+      i2c_master_start(link);
+      i2c_master_write_byte(link, address, true);
+      i2c_master_write(link, flush.startLine, sizeof(flush.startLine), true);
+    }
+    i2c_master_stop(link);
+
+    wire->setClock(wireClk);
+    esp_err_t result = i2c_master_cmd_begin(NAMI_DISPLAY_I2C_PORT, link, pdMS_TO_TICKS(NAMI_DISPLAY_I2C_TIMEOUT));
+    wire->setClock(restoreClk);
+    i2c_cmd_link_delete_static(link);
+    return result == ESP_OK;
+  }
+#else
+  /**
+   * Sends a flush through Wire, in NAMI_DISPLAY_I2C_CHUNK transactions
+   * @return false if the panel did not acknowledge
+   */
+  bool sendFlush(const DisplayFlush& flush) {
+    bool ok = true;
+    wire->setClock(wireClk);
+    for (int i = 0; i < flush.windowCount; i++) {
+      const DisplayFlush::Window& window = flush.windows[i];
+      wire->beginTransmission(i2caddr);
+      wire->write(window.command, sizeof(window.command));
+      ok &= wire->endTransmission() == 0;
+
+      const uint8_t* data = flush.data + window.offset + 1;
+      int remaining = window.length;
+      while (remaining > 0) {
+        int chunk = min(remaining, NAMI_DISPLAY_I2C_CHUNK - 1);
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)0x40);
+        wire->write(data, chunk);
+        ok &= wire->endTransmission() == 0;
+        data += chunk;
+        remaining -= chunk;
+      }
+    }
+    if (flush.sendStartLine) {
+      wire->beginTransmission(i2caddr);
+      wire->write(flush.startLine, sizeof(flush.startLine));
+      ok &= wire->endTransmission() == 0;
+    }
+    wire->setClock(restoreClk);
+    return ok;
+  }
+#endif
+};
+
+#endif // NAMI_DISPLAY_H
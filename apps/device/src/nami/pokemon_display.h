@@ -1,128 +1,242 @@
 #ifndef POKEMON_DISPLAY_H
 #define POKEMON_DISPLAY_H
 
-#include <Adafruit_SSD1306.h>
-#include <ArduinoJson.h>
+#include <atomic>
+#include "nami_display.h"
+#include "frame_protocol.h"
+#include "bitmap_blit.h"
+#include "sprite_codec.h"
+#include "json_stream.h"
+#include "render_queue.h"
+#include "text_layout.h"
+#include "log.h"
+
+/**
+ * Bitmap currently on screen, the base for FRAME_TYPE_DELTA patches
+ * (render task only)
+ */
+struct ShownBitmap {
+  uint16_t seq;  // Server sequence number, 0 when the screen shows anything else
+  uint8_t width;
+  uint8_t height;
+};
+
+ShownBitmap shownBitmap = {0, 0, 0};
+
+// Published by the render task, acknowledged to the server by the network task
+std::atomic<uint16_t> presentedSeq(0);
+// Seq of the last delta whose base was no longer on screen
+std::atomic<uint16_t> rejectedSeq(0);
+
+/**
+ * Records which server frame is now on screen
+ * @param seq Sequence number of the frame, 0 if it cannot serve as a delta base
+ * @param width Bitmap width in pixels
+ * @param height Bitmap height in pixels
+ */
+void setShownBitmap(uint16_t seq, uint8_t width = 0, uint8_t height = 0) {
+  shownBitmap.seq = seq;
+  shownBitmap.width = width;
+  shownBitmap.height = height;
+  presentedSeq.store(seq, std::memory_order_release);
+}
+
+/**
+ * Computes where a Pokemon bitmap goes on screen: centered below the
+ * header line, clamped to the screen edges
+ * @param width Bitmap width in pixels
+ * @param height Bitmap height in pixels
+ * @param x Output left edge
+ * @param y Output top edge
+ */
+void pokemonBitmapOrigin(int width, int height, int& x, int& y) {
+  // Leave space for header (8 pixels) and some padding
+  int availableHeight = 64 - 8; // Screen height minus header line
+  int availableWidth = 128;
+  
+  x = (availableWidth - width) / 2;
+  y = 8 + (availableHeight - height) / 2; // Start after header
+  
+  // Ensure bitmap doesn't go out of bounds
+  if (x < 0) x = 0;
+  if (y < 8) y = 8;
+  if (x + width > 128) x = 128 - width;
+  if (y + height > 64) y = 64 - height;
+}
+
+/**
+ * Draws the "#{id} {name}" header line, centered on the first text row
+ * @param display Reference to the NamiDisplay object
+ * @param pokemonId Pokemon ID number
+ * @param pokemonName Pokemon name
+ */
+void drawPokemonHeader(NamiDisplay& display, int pokemonId, const char* pokemonName) {
+  char header[48];
+  int n = snprintf(header, sizeof(header), "#%d %s", pokemonId, pokemonName);
+  size_t length = min((size_t)max(n, 0), sizeof(header) - 1);
+  for (size_t i = 0; i < length; i++) {
+    header[i] = tolower(header[i]); // Convert to lowercase for display
+  }
+
+  // Truncate header if too long (21 chars for 128px width), then center it
+  length = truncateText(header, length, TEXT_COLUMNS);
+  drawCenteredLine(display, 0, header, length);
+}
+
+/**
+ * Marks the 8-row bands reported by blitRleBitmap() as dirty
+ */
+void markTouchedBands(NamiDisplay& display, int x, int y, int width, int height, uint32_t bands) {
+  for (int band = 0; bands != 0; band++, bands >>= 1) {
+    if (bands & 1) {
+      display.markDirty(x, y + band * 8, width, min(8, height - band * 8));
+    }
+  }
+}
 
 /**
  * Display Pokemon bitmap on OLED screen
  * First line shows "#{id} {name}" (e.g., "#1 bulbasaur")
  * Bitmap is centered horizontally and vertically based on its size
  * 
- * @param display Reference to the Adafruit_SSD1306 display object
+ * @param display Reference to the NamiDisplay object
  * @param pokemonId Pokemon ID number
  * @param pokemonName Pokemon name
- * @param width Bitmap width in pixels (must be multiple of 8)
+ * @param width Bitmap width in pixels (rows are padded to whole bytes)
  * @param height Bitmap height in pixels
  * @param bitmapData Array of bytes representing the bitmap (1-bit per pixel, MSB first)
  * @param bitmapSize Size of bitmapData array in bytes
+ * @param flags FRAME_FLAG_RLE if bitmapData is PackBits compressed
+ * @return false if the bitmap was rejected (it is not on screen, so it
+ *         cannot serve as a delta base)
  */
-void displayPokemonBitmap(
-  Adafruit_SSD1306& display,
+bool displayPokemonBitmap(
+  NamiDisplay& display,
   int pokemonId,
-  const String& pokemonName,
+  const char* pokemonName,
   int width,
   int height,
   const uint8_t* bitmapData,
-  size_t bitmapSize
+  size_t bitmapSize,
+  uint8_t flags = 0
 ) {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
   
-  // Calculate expected bitmap size
-  int bytesPerRow = width / 8;
+  // Calculate expected bitmap size (rows are padded to whole bytes, as blitBitmap reads them)
+  int bytesPerRow = (width + 7) / 8;
   int expectedSize = bytesPerRow * height;
   
-  // Validate bitmap size
-  if (bitmapSize < expectedSize) {
-    Serial.print("[Pokemon] Error: Bitmap size mismatch. Expected: ");
-    Serial.print(expectedSize);
-    Serial.print(", Got: ");
-    Serial.println(bitmapSize);
+  bool compressed = flags & FRAME_FLAG_RLE;
+
+  // Validate bitmap size (compressed data is checked while decoding)
+  if (!compressed && bitmapSize < expectedSize) {
+    LOG_ERROR("Pokemon", "Bitmap size mismatch. Expected: %d, Got: %u", expectedSize, (unsigned)bitmapSize);
     
     display.setCursor(0, 20);
     display.println("Bitmap Error");
     display.display();
-    return;
+    return false;
   }
   
   // Display Pokemon name and ID on first line
-  String header = "#" + String(pokemonId) + " " + pokemonName;
-  header.toLowerCase(); // Convert to lowercase for display
-  
-  // Truncate header if too long (max ~21 chars for 128px width)
-  if (header.length() > 21) {
-    header = header.substring(0, 18) + "...";
-  }
-  
-  // Center the header text
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(header.c_str(), 0, 0, &x1, &y1, &w, &h);
-  int xHeader = (128 - w) / 2;
-  display.setCursor(xHeader, 0);
-  display.println(header);
+  drawPokemonHeader(display, pokemonId, pokemonName);
   
   // Calculate bitmap position (centered horizontally and vertically)
-  // Leave space for header (8 pixels) and some padding
-  int availableHeight = 64 - 8; // Screen height minus header line
-  int availableWidth = 128;
+  int xBitmap, yBitmap;
+  pokemonBitmapOrigin(width, height, xBitmap, yBitmap);
   
-  int xBitmap = (availableWidth - width) / 2;
-  int yBitmap = 8 + (availableHeight - height) / 2; // Start after header
-  
-  // Ensure bitmap doesn't go out of bounds
-  if (xBitmap < 0) xBitmap = 0;
-  if (yBitmap < 8) yBitmap = 8;
-  if (xBitmap + width > 128) xBitmap = 128 - width;
-  if (yBitmap + height > 64) yBitmap = 64 - height;
-  
-  // Draw bitmap pixel by pixel manually to ensure correct display
+  // Blit straight into the SSD1306 buffer, 8x8 blocks at a time
   // Our bitmap data is in MSB-first format (1 byte = 8 pixels horizontally)
-  // Each byte represents 8 horizontal pixels, with MSB being the leftmost pixel
-  // bytesPerRow is already declared above
-  
-  for (int y = 0; y < height; y++) {
-    for (int x = 0; x < bytesPerRow; x++) {
-      uint8_t byte = bitmapData[y * bytesPerRow + x];
-      
-      // Extract each bit from the byte (MSB first)
-      for (int bit = 0; bit < 8; bit++) {
-        int pixelX = x * 8 + bit;
-        if (pixelX >= width) break; // Don't draw beyond bitmap width
-        
-        // Check if bit is set (MSB first: bit 7 is leftmost)
-        bool pixelOn = (byte & (1 << (7 - bit))) != 0;
-        
-        // Draw pixel at screen position
-        int screenX = xBitmap + pixelX;
-        int screenY = yBitmap + y;
-        
-        if (pixelOn) {
-          display.drawPixel(screenX, screenY, SSD1306_WHITE);
-        }
-      }
+  bool ok = true;
+  if (compressed) {
+    // Decompressed one 8-row band at a time, straight into the framebuffer
+    ok = blitRleBitmap(display.getBuffer(), display.width(), display.height(),
+                       xBitmap, yBitmap, bitmapData, bitmapSize, width, height, BLIT_OR);
+    if (!ok) {
+      LOG_ERROR("Pokemon", "Compressed bitmap is truncated or corrupt");
     }
+  } else {
+    blitBitmap(
+      display.getBuffer(),
+      display.width(),
+      display.height(),
+      xBitmap,
+      yBitmap,
+      bitmapData,
+      width,
+      height,
+      BLIT_OR
+    );
   }
+  display.markDirty(xBitmap, yBitmap, width, height);
   
   display.display();
   
-  Serial.print("[Pokemon] Displayed: #");
-  Serial.print(pokemonId);
-  Serial.print(" ");
-  Serial.print(pokemonName);
-  Serial.print(" (");
-  Serial.print(width);
-  Serial.print("x");
-  Serial.print(height);
-  Serial.print(", ");
-  Serial.print(bitmapSize);
-  Serial.println(" bytes)");
+  LOG_INFO("Pokemon", "Displayed: #%d %s (%dx%d, %u bytes%s)", pokemonId, pokemonName, width, height,
+           (unsigned)bitmapSize, compressed ? " compressed" : "");
+  return ok;
 }
 
 /**
- * Parse Pokemon bitmap JSON and display it
+ * Applies a FRAME_TYPE_DELTA patch to the bitmap on screen
+ * The patch is XORed into the framebuffer in place, and only the 8-row
+ * bands it changes are flushed. If its base frame is no longer on screen,
+ * nothing is drawn and the network task asks the server for a full frame.
+ *
+ * @param display Reference to the NamiDisplay object
+ * @param frame RENDER_DELTA frame
+ * @return true if the patch was applied
+ */
+bool applyPokemonDelta(NamiDisplay& display, const RenderFrame& frame) {
+  if (frame.baseSeq == 0 || frame.baseSeq != shownBitmap.seq ||
+      frame.width != shownBitmap.width || frame.height != shownBitmap.height) {
+    LOG_WARN("Pokemon", "Delta base %u not on screen (showing %u), requesting full frame",
+             (unsigned)frame.baseSeq, (unsigned)shownBitmap.seq);
+    rejectedSeq.store(frame.seq, std::memory_order_release);
+    return false;
+  }
+
+  int x, y;
+  pokemonBitmapOrigin(frame.width, frame.height, x, y);
+
+  display.beginFrame();
+  if (frame.name[0] != '\0') {
+    // A different Pokemon: redraw the header line as well
+    display.fillRect(0, 0, display.width(), 8, SSD1306_BLACK);
+    drawPokemonHeader(display, frame.id, frame.name);
+  }
+
+  bool ok = true;
+  if (frame.flags & FRAME_FLAG_RLE) {
+    uint32_t bands = 0;
+    ok = blitRleBitmap(display.getBuffer(), display.width(), display.height(),
+                       x, y, frame.data, frame.length, frame.width, frame.height, BLIT_XOR, &bands);
+    markTouchedBands(display, x, y, frame.width, frame.height, bands);
+  } else {
+    blitBitmap(display.getBuffer(), display.width(), display.height(),
+               x, y, frame.data, frame.width, frame.height, BLIT_XOR);
+    display.markDirty(x, y, frame.width, frame.height);
+  }
+  display.presentFrame();
+
+  if (!ok) {
+    // Part of the patch is missing, so the screen no longer matches any frame
+    LOG_ERROR("Pokemon", "Delta is truncated or corrupt");
+    setShownBitmap(0);
+    rejectedSeq.store(frame.seq, std::memory_order_release);
+    return false;
+  }
+
+  setShownBitmap(frame.seq, frame.width, frame.height);
+  LOG_INFO("Pokemon", "Applied delta %u -> %u (%u bytes)", (unsigned)frame.baseSeq, (unsigned)frame.seq,
+           (unsigned)frame.length);
+  return true;
+}
+
+/**
+ * Parse a Pokemon bitmap JSON message into a render frame
  * Expected JSON format:
  * {
  *   "type": "pokemon_bitmap",
@@ -135,76 +249,154 @@ void displayPokemonBitmap(
  *   }
  * }
  * 
- * @param display Reference to the Adafruit_SSD1306 display object
- * @param jsonString JSON string containing Pokemon bitmap data
- * @return true if successfully parsed and displayed, false otherwise
+ * The message is read with a streaming parser: bitmapData elements are
+ * written into the frame's data buffer as they are parsed, so memory use
+ * does not depend on the payload size.
+ * 
+ * @param json JSON text (not necessarily null terminated)
+ * @param length Length of the JSON text in bytes
+ * @param frame Render frame to fill
+ * @return true if this was a valid Pokemon bitmap message, false otherwise
  */
-bool parseAndDisplayPokemonBitmap(Adafruit_SSD1306& display, const String& jsonString) {
-  StaticJsonDocument<8192> doc; // Large enough for bitmap data + metadata
-  
-  DeserializationError error = deserializeJson(doc, jsonString);
-  
-  if (error) {
-    Serial.print("[Pokemon] JSON parse error: ");
-    Serial.println(error.c_str());
+bool parsePokemonBitmapJson(const char* json, size_t length, RenderFrame& frame) {
+  if (!looksLikeJsonObject(json, length)) {
     return false;
   }
-  
-  // Check if this is a Pokemon bitmap message
-  if (!doc.containsKey("type") || doc["type"] != "pokemon_bitmap") {
+
+  JsonStream stream(json, length);
+  char key[16];
+  char type[24] = "";
+  long pokemonId = 0;
+  long width = 0;
+  long height = 0;
+  size_t bitmapSize = 0;
+  bool overflow = false;
+
+  strcpy(frame.name, "unknown");
+
+  if (!stream.beginObject()) {
     return false;
   }
-  
-  if (!doc.containsKey("data")) {
-    Serial.println("[Pokemon] Missing 'data' field");
+
+  while (stream.nextKey(key, sizeof(key))) {
+    if (strcmp(key, "type") == 0) {
+      stream.readString(type, sizeof(type));
+      // Bail out early on every other message type
+      if (strcmp(type, "pokemon_bitmap") != 0) {
+        return false;
+      }
+    } else if (strcmp(key, "data") == 0) {
+      if (!stream.beginObject()) {
+        break;
+      }
+      while (stream.nextKey(key, sizeof(key))) {
+        if (strcmp(key, "pokemonId") == 0) {
+          stream.readInt(pokemonId);
+        } else if (strcmp(key, "pokemonName") == 0) {
+          stream.readString(frame.name, sizeof(frame.name));
+        } else if (strcmp(key, "width") == 0) {
+          stream.readInt(width);
+        } else if (strcmp(key, "height") == 0) {
+          stream.readInt(height);
+        } else if (strcmp(key, "bitmapData") == 0) {
+          if (!stream.beginArray()) {
+            break;
+          }
+          while (stream.nextElement()) {
+            long value = 0;
+            if (!stream.readInt(value)) {
+              break;
+            }
+            if (bitmapSize < sizeof(frame.data)) {
+              frame.data[bitmapSize++] = (uint8_t)value;
+            } else {
+              overflow = true;
+            }
+          }
+        } else {
+          stream.skipValue();
+        }
+      }
+    } else {
+      stream.skipValue();
+    }
+  }
+
+  if (stream.error()) {
+    LOG_WARN("Pokemon", "JSON parse error");
     return false;
   }
-  
-  JsonObject data = doc["data"];
-  
-  // Extract Pokemon information
-  int pokemonId = data["pokemonId"] | 0;
-  String pokemonName = data["pokemonName"] | "unknown";
-  int width = data["width"] | 0;
-  int height = data["height"] | 0;
-  
-  if (pokemonId == 0 || width == 0 || height == 0) {
-    Serial.println("[Pokemon] Invalid Pokemon data");
+
+  // Check if this is a Pokemon bitmap message
+  if (strcmp(type, "pokemon_bitmap") != 0) {
     return false;
   }
-  
-  // Extract bitmap data array
-  if (!data.containsKey("bitmapData") || !data["bitmapData"].is<JsonArray>()) {
-    Serial.println("[Pokemon] Missing or invalid bitmapData array");
+
+  if (pokemonId == 0 || width <= 0 || height <= 0 || width > 255 || height > 255) {
+    LOG_WARN("Pokemon", "Invalid Pokemon data");
     return false;
   }
-  
-  JsonArray bitmapArray = data["bitmapData"];
-  size_t bitmapSize = bitmapArray.size();
-  
+
+  if (overflow) {
+    LOG_WARN("Pokemon", "Bitmap larger than the frame buffer");
+    return false;
+  }
+
   if (bitmapSize == 0) {
-    Serial.println("[Pokemon] Empty bitmap data");
+    LOG_WARN("Pokemon", "Empty bitmap data");
     return false;
   }
-  
-  // Allocate buffer for bitmap data
-  uint8_t* bitmapData = new uint8_t[bitmapSize];
-  if (!bitmapData) {
-    Serial.println("[Pokemon] Failed to allocate memory for bitmap");
+
+  frame.id = pokemonId;
+  frame.width = width;
+  frame.height = height;
+  frame.length = bitmapSize;
+  return true;
+}
+
+/**
+ * Decode a Pokemon bitmap (or a delta patch) received as a binary WebSocket
+ * frame into a render frame (see frame_protocol.h for the layout)
+ *
+ * @param payload Raw WebSocket binary payload
+ * @param length Payload length in bytes
+ * @param frame Render frame to fill
+ * @return true if the frame was valid, false otherwise
+ */
+bool decodePokemonFrame(const uint8_t* payload, size_t length, RenderFrame& frame) {
+  NamiFrame decoded;
+  if (!decodeFrame(payload, length, decoded)) {
+    LOG_WARN("Pokemon", "Invalid binary frame");
     return false;
   }
-  
-  // Copy bitmap data from JSON array
-  for (size_t i = 0; i < bitmapSize; i++) {
-    bitmapData[i] = bitmapArray[i].as<uint8_t>();
+
+  if (decoded.type != FRAME_TYPE_BITMAP && decoded.type != FRAME_TYPE_DELTA) {
+    LOG_WARN("Pokemon", "Unsupported frame type: %u", (unsigned)decoded.type);
+    return false;
   }
-  
-  // Display the bitmap
-  displayPokemonBitmap(display, pokemonId, pokemonName, width, height, bitmapData, bitmapSize);
-  
-  // Free allocated memory
-  delete[] bitmapData;
-  
+
+  // Compressed bitmaps are queued as they are and decoded by the renderer
+  bool compressed = decoded.flags & FRAME_FLAG_RLE;
+  size_t bitmapSize = compressed ? decoded.dataLength
+                                 : (size_t)((decoded.width + 7) / 8) * decoded.height;
+  if (bitmapSize > sizeof(frame.data)) {
+    LOG_WARN("Pokemon", "Bitmap larger than the frame buffer");
+    return false;
+  }
+
+  // The name is not null terminated inside the payload
+  size_t nameLength = min((size_t)decoded.nameLength, sizeof(frame.name) - 1);
+  memcpy(frame.name, decoded.name, nameLength);
+  frame.name[nameLength] = '\0';
+
+  frame.id = decoded.id;
+  frame.width = decoded.width;
+  frame.height = decoded.height;
+  frame.flags = decoded.flags & FRAME_FLAG_RLE;
+  frame.seq = decoded.seq;
+  frame.baseSeq = decoded.baseSeq;
+  frame.length = bitmapSize;
+  memcpy(frame.data, decoded.data, bitmapSize);
   return true;
 }
 
@@ -0,0 +1,193 @@
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "log.h"
+
+/**
+ * Lock-free single-producer/single-consumer ring of fixed-size slots
+ *
+ * The producer fills a slot in place (beginPush/commitPush) and the consumer
+ * reads it in place (front/pop), so frames are decoded straight into their
+ * slot and never copied again. One side may only ever be used from one task.
+ */
+template <typename T, size_t N>
+class SpscQueue {
+public:
+  SpscQueue() : head(0), tail(0), drops(0) {}
+
+  /**
+   * @return a free slot to fill, or nullptr when the queue is full
+   */
+  T* beginPush() {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) >= N) {
+      drops++;
+      return nullptr;
+    }
+    return &slots[h % N];
+  }
+
+  /**
+   * Publishes the slot returned by beginPush() to the consumer
+   */
+  void commitPush() {
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * @return the oldest published slot, or nullptr when the queue is empty
+   */
+  T* front() {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &slots[t % N];
+  }
+
+  /**
+   * Releases the slot returned by front() back to the producer
+   */
+  void pop() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  /**
+   * @return number of pushes rejected because the queue was full
+   */
+  uint32_t dropped() const {
+    return drops;
+  }
+
+private:
+  T slots[N];
+  std::atomic<size_t> head;
+  std::atomic<size_t> tail;
+  uint32_t drops;
+};
+
+// Largest payload a frame can carry (ASCII art and long messages included)
+#define RENDER_FRAME_CAPACITY 2048
+#define RENDER_QUEUE_DEPTH 4
+
+enum RenderKind : uint8_t {
+  RENDER_BITMAP,       // Pokemon bitmap: id, name, width, height, 1bpp data
+  RENDER_TEXT,         // Chat message, word wrapped and centered
+  RENDER_ASCII_ART,    // Multi-line text, line breaks preserved
+  RENDER_STATUS,       // Up to 3 centered status lines separated by '\n'
+  RENDER_SYSTEM_INFO,  // Info screen: fixed-size lines (system_info.h), id = line mask
+  RENDER_INFO_PATCH,   // Same layout, only the lines in id are redrawn
+  RENDER_ANIMATION,    // Start playing animation slot id (animation_player.h)
+  RENDER_DELTA,        // XOR patch for the bitmap on screen (baseSeq), same fields as RENDER_BITMAP
+};
+
+/**
+ * Decoded frame descriptor handed from the network task to the render task
+ */
+struct RenderFrame {
+  RenderKind kind;
+  uint16_t id;
+  uint8_t width;
+  uint8_t height;
+  uint8_t flags;     // FRAME_FLAG_* describing data (bitmaps only)
+  uint16_t seq;      // Server frame sequence number, 0 if untracked
+  uint16_t baseSeq;  // RENDER_DELTA only
+  char name[32];
+  uint32_t receivedAt;  // micros() the server message arrived, 0 if queued by the device itself
+  uint32_t parsedAt;    // micros() the frame was committed
+  uint32_t traceId;     // Server trace of the message, 0 if untraced (telemetry.h)
+  uint32_t traceTs;     // Server timestamp of the trace, echoed in the ack
+  size_t length;
+  uint8_t data[RENDER_FRAME_CAPACITY];
+};
+
+SpscQueue<RenderFrame, RENDER_QUEUE_DEPTH> renderQueue;
+
+// Render task to wake up when a frame is published (null until tasks start)
+TaskHandle_t renderTaskHandle = nullptr;
+
+// Arrival time and trace of the server message being decoded, 0 while the
+// device queues frames of its own (network task only, see telemetry.h)
+uint32_t messageReceivedAt = 0;
+uint32_t messageTraceId = 0;
+uint32_t messageTraceTs = 0;
+
+// Slot between beginRenderFrame() and commitRenderFrame()
+RenderFrame* openRenderFrame = nullptr;
+
+/**
+ * Reserves the next render slot
+ * @param kind Kind of frame about to be written
+ * @return the slot to fill, or nullptr when the renderer is behind
+ */
+RenderFrame* beginRenderFrame(RenderKind kind) {
+  RenderFrame* frame = renderQueue.beginPush();
+  if (frame == nullptr) {
+    LOG_WARN("Render", "Queue full, dropping frame");
+    return nullptr;
+  }
+  frame->kind = kind;
+  frame->id = 0;
+  frame->width = 0;
+  frame->height = 0;
+  frame->flags = 0;
+  frame->seq = 0;
+  frame->baseSeq = 0;
+  frame->name[0] = '\0';
+  frame->receivedAt = messageReceivedAt;
+  frame->parsedAt = 0;
+  frame->traceId = messageTraceId;
+  frame->traceTs = messageTraceTs;
+  frame->length = 0;
+  openRenderFrame = frame;
+  return frame;
+}
+
+/**
+ * Publishes a filled slot and wakes the render task
+ */
+void commitRenderFrame() {
+  openRenderFrame->parsedAt = micros();
+  renderQueue.commitPush();
+  if (renderTaskHandle != nullptr) {
+    xTaskNotifyGive(renderTaskHandle);
+  }
+}
+
+/**
+ * Queues a text frame (message, ASCII art or info lines)
+ * Text longer than RENDER_FRAME_CAPACITY is truncated.
+ * @return true if the frame was queued
+ */
+bool queueText(RenderKind kind, const char* text, size_t length) {
+  RenderFrame* frame = beginRenderFrame(kind);
+  if (frame == nullptr) {
+    return false;
+  }
+  frame->length = min(length, sizeof(frame->data));
+  memcpy(frame->data, text, frame->length);
+  commitRenderFrame();
+  return true;
+}
+
+/**
+ * Queues a status screen of up to three centered lines
+ * @return true if the frame was queued
+ */
+bool queueStatus(const char* line1, const char* line2 = nullptr, const char* line3 = nullptr) {
+  RenderFrame* frame = beginRenderFrame(RENDER_STATUS);
+  if (frame == nullptr) {
+    return false;
+  }
+  int n = snprintf((char*)frame->data, sizeof(frame->data), "%s%s%s%s%s",
+                   line1,
+                   line2 ? "\n" : "", line2 ? line2 : "",
+                   line3 ? "\n" : "", line3 ? line3 : "");
+  frame->length = min((size_t)max(n, 0), sizeof(frame->data) - 1);
+  commitRenderFrame();
+  return true;
+}
+
+#endif // RENDER_QUEUE_H
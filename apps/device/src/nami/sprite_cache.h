@@ -0,0 +1,260 @@
+#ifndef SPRITE_CACHE_H
+#define SPRITE_CACHE_H
+
+#include <LittleFS.h>
+#include "frame_protocol.h"
+#include "render_queue.h"
+#include "pokemon_display.h"
+#include "log.h"
+
+/**
+ * Persistent sprite cache in flash, keyed by Pokemon id
+ *
+ * Every bitmap frame received from the server is stored as-is (header,
+ * name and possibly compressed payload) in /sprites/<id>. The server can
+ * then show a sprite again with an 8 byte FRAME_TYPE_SHOW_CACHED frame.
+ * The least recently shown sprites are evicted once the cache exceeds
+ * SPRITE_CACHE_BUDGET bytes or SPRITE_CACHE_MAX_ENTRIES files.
+ *
+ * The LRU index lives in RAM and is persisted to /sprites/index whenever
+ * it changes, so the cache and its order survive reboots. All functions
+ * must be called from the task that owns the WebSocket.
+ */
+
+#define SPRITE_CACHE_DIR "/sprites"
+#define SPRITE_CACHE_INDEX "/sprites/index"
+#define SPRITE_CACHE_BUDGET (64 * 1024)  // Bytes of sprite files
+#define SPRITE_CACHE_MAX_ENTRIES 48
+#define SPRITE_CACHE_INDEX_VERSION 1
+
+// Largest stored frame: header, longest name, fullest payload
+#define SPRITE_CACHE_FILE_CAPACITY (NAMI_FRAME_HEADER_SIZE + 255 + RENDER_FRAME_CAPACITY)
+
+struct SpriteCacheEntry {
+  uint16_t id;
+  uint16_t size;      // File size in bytes
+  uint32_t lastUsed;  // Value of SpriteCache::clock when last shown
+};
+
+struct SpriteCache {
+  bool mounted;
+  uint8_t count;
+  uint32_t clock;
+  uint32_t bytes;
+  SpriteCacheEntry entries[SPRITE_CACHE_MAX_ENTRIES];
+};
+
+SpriteCache spriteCache;
+
+// File staging buffer, so a cached frame decodes exactly like a received one
+uint8_t spriteCacheBuffer[SPRITE_CACHE_FILE_CAPACITY];
+
+/**
+ * Builds the file name of a cached sprite
+ */
+void spriteCachePath(uint16_t id, char* path, size_t size) {
+  snprintf(path, size, SPRITE_CACHE_DIR "/%u", id);
+}
+
+/**
+ * @return index of the entry for id, or -1 if it is not cached
+ */
+int spriteCacheFind(uint16_t id) {
+  for (int i = 0; i < spriteCache.count; i++) {
+    if (spriteCache.entries[i].id == id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+/**
+ * Writes the LRU index to flash
+ */
+void spriteCacheSaveIndex() {
+  File file = LittleFS.open(SPRITE_CACHE_INDEX, "w");
+  if (!file) {
+    LOG_ERROR("Cache", "Could not write index");
+    return;
+  }
+  uint8_t header[2] = {SPRITE_CACHE_INDEX_VERSION, spriteCache.count};
+  file.write(header, sizeof(header));
+  file.write((const uint8_t*)spriteCache.entries, spriteCache.count * sizeof(SpriteCacheEntry));
+  file.close();
+}
+
+/**
+ * Removes one entry and its file
+ */
+void spriteCacheRemove(int index) {
+  char path[24];
+  spriteCachePath(spriteCache.entries[index].id, path, sizeof(path));
+  LittleFS.remove(path);
+
+  spriteCache.bytes -= spriteCache.entries[index].size;
+  spriteCache.count--;
+  spriteCache.entries[index] = spriteCache.entries[spriteCache.count];
+}
+
+/**
+ * Mounts the filesystem (formatting it on first use) and loads the index
+ * Entries whose file is missing are dropped.
+ * @return true if the cache is usable
+ */
+bool spriteCacheBegin() {
+  spriteCache.mounted = LittleFS.begin(true);
+  spriteCache.count = 0;
+  spriteCache.clock = 0;
+  spriteCache.bytes = 0;
+  if (!spriteCache.mounted) {
+    LOG_ERROR("Cache", "LittleFS mount failed, sprite cache disabled");
+    return false;
+  }
+  LittleFS.mkdir(SPRITE_CACHE_DIR);
+
+  File file = LittleFS.open(SPRITE_CACHE_INDEX, "r");
+  uint8_t header[2];
+  if (file && file.read(header, sizeof(header)) == sizeof(header) &&
+      header[0] == SPRITE_CACHE_INDEX_VERSION && header[1] <= SPRITE_CACHE_MAX_ENTRIES) {
+    size_t bytes = header[1] * sizeof(SpriteCacheEntry);
+    if (file.read((uint8_t*)spriteCache.entries, bytes) == bytes) {
+      spriteCache.count = header[1];
+    }
+  }
+  if (file) {
+    file.close();
+  }
+
+  bool dropped = false;
+  for (int i = spriteCache.count - 1; i >= 0; i--) {
+    char path[24];
+    spriteCachePath(spriteCache.entries[i].id, path, sizeof(path));
+    if (!LittleFS.exists(path)) {
+      spriteCache.count--;
+      spriteCache.entries[i] = spriteCache.entries[spriteCache.count];
+      dropped = true;
+      continue;
+    }
+    spriteCache.bytes += spriteCache.entries[i].size;
+    spriteCache.clock = max(spriteCache.clock, spriteCache.entries[i].lastUsed);
+  }
+  if (dropped) {
+    spriteCacheSaveIndex();
+  }
+
+  LOG_INFO("Cache", "%u sprites, %u bytes", (unsigned)spriteCache.count, (unsigned)spriteCache.bytes);
+  return true;
+}
+
+/**
+ * Stores a received bitmap frame, evicting least recently used sprites
+ * until it fits the budget
+ * @param id Pokemon id
+ * @param payload Complete binary frame, as received
+ * @param length Frame length in bytes
+ * @return true if the sprite was stored
+ */
+bool spriteCacheStore(uint16_t id, const uint8_t* payload, size_t length) {
+  if (!spriteCache.mounted || length > SPRITE_CACHE_FILE_CAPACITY || length > SPRITE_CACHE_BUDGET) {
+    return false;
+  }
+
+  int existing = spriteCacheFind(id);
+  if (existing >= 0) {
+    spriteCacheRemove(existing);
+  }
+
+  while (spriteCache.count > 0 &&
+         (spriteCache.count >= SPRITE_CACHE_MAX_ENTRIES || spriteCache.bytes + length > SPRITE_CACHE_BUDGET)) {
+    int oldest = 0;
+    for (int i = 1; i < spriteCache.count; i++) {
+      if (spriteCache.entries[i].lastUsed < spriteCache.entries[oldest].lastUsed) {
+        oldest = i;
+      }
+    }
+    LOG_INFO("Cache", "Evicting #%u", (unsigned)spriteCache.entries[oldest].id);
+    spriteCacheRemove(oldest);
+  }
+
+  char path[24];
+  spriteCachePath(id, path, sizeof(path));
+  File file = LittleFS.open(path, "w");
+  if (!file) {
+    spriteCacheSaveIndex();
+    return false;
+  }
+  size_t written = file.write(payload, length);
+  file.close();
+  if (written != length) {
+    LittleFS.remove(path);
+    spriteCacheSaveIndex();
+    return false;
+  }
+
+  SpriteCacheEntry& entry = spriteCache.entries[spriteCache.count++];
+  entry.id = id;
+  entry.size = (uint16_t)length;
+  entry.lastUsed = ++spriteCache.clock;
+  spriteCache.bytes += length;
+  spriteCacheSaveIndex();
+  return true;
+}
+
+/**
+ * Loads a cached sprite into a render frame and marks it most recently used
+ * @param id Pokemon id
+ * @param frame Render frame to fill
+ * @return false on a cache miss
+ */
+bool spriteCacheLoad(uint16_t id, RenderFrame& frame) {
+  int index = spriteCacheFind(id);
+  if (!spriteCache.mounted || index < 0) {
+    return false;
+  }
+
+  char path[24];
+  spriteCachePath(id, path, sizeof(path));
+  File file = LittleFS.open(path, "r");
+  if (!file) {
+    spriteCacheRemove(index);
+    spriteCacheSaveIndex();
+    return false;
+  }
+  size_t length = file.read(spriteCacheBuffer, sizeof(spriteCacheBuffer));
+  file.close();
+
+  if (length != spriteCache.entries[index].size || !decodePokemonFrame(spriteCacheBuffer, length, frame)) {
+    LOG_WARN("Cache", "Dropping corrupt sprite #%u", (unsigned)id);
+    spriteCacheRemove(index);
+    spriteCacheSaveIndex();
+    return false;
+  }
+
+  // Only rewrite the index when the order actually changes
+  if (spriteCache.entries[index].lastUsed != spriteCache.clock) {
+    spriteCache.entries[index].lastUsed = ++spriteCache.clock;
+    spriteCacheSaveIndex();
+  }
+  return true;
+}
+
+/**
+ * Writes the cached ids as a comma separated list (e.g. "1,25,150")
+ * @param out Output buffer, always null terminated
+ * @param size Size of the output buffer
+ */
+void spriteCacheListIds(char* out, size_t size) {
+  size_t used = 0;
+  out[0] = '\0';
+  for (int i = 0; i < spriteCache.count && used < size; i++) {
+    int n = snprintf(out + used, size - used, i == 0 ? "%u" : ",%u", spriteCache.entries[i].id);
+    if (n < 0 || used + n >= size) {
+      // Never send a half-written id
+      out[used] = '\0';
+      break;
+    }
+    used += n;
+  }
+}
+
+#endif // SPRITE_CACHE_H
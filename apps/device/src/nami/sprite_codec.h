@@ -0,0 +1,167 @@
+#ifndef SPRITE_CODEC_H
+#define SPRITE_CODEC_H
+
+#include <Arduino.h>
+#include "bitmap_blit.h"
+
+/**
+ * PackBits run-length coding for 1bpp sprites
+ *
+ * Sprites are mostly empty background, so long runs of 0x00 dominate and a
+ * byte-oriented RLE shrinks them several times over at almost no decode
+ * cost. The stream is a sequence of packets, each starting with a control
+ * byte n:
+ *   0..127    n + 1 literal bytes follow
+ *   129..255  the next byte is repeated 257 - n times (2..128)
+ *   128       no-op
+ *
+ * The encoder lives in apps/server/src/device/protocol.ts (encodeRle).
+ */
+
+// Widest sprite the band window can hold (255 px wide frames, rounded up)
+#define RLE_MAX_STRIDE 32
+
+/**
+ * Streaming PackBits decoder
+ * Output can be pulled in pieces of any size; a run or literal that spans
+ * two reads is resumed where it stopped.
+ */
+class RleDecoder {
+public:
+  RleDecoder(const uint8_t* data, size_t length)
+    : pos(data), end(data + length), literal(0), repeat(0), value(0), failed(false) {}
+
+  /**
+   * @return true once the stream ended early or was malformed
+   */
+  bool error() const {
+    return failed;
+  }
+
+  /**
+   * Decodes up to count bytes
+   * @param out Output buffer
+   * @param count Number of bytes wanted
+   * @return number of bytes written (less than count only on error)
+   */
+  size_t read(uint8_t* out, size_t count) {
+    size_t written = 0;
+    while (written < count) {
+      if (repeat > 0) {
+        size_t n = min(repeat, count - written);
+        memset(out + written, value, n);
+        repeat -= n;
+        written += n;
+        continue;
+      }
+
+      if (literal > 0) {
+        size_t n = min(min(literal, count - written), (size_t)(end - pos));
+        if (n == 0) {
+          failed = true;
+          break;
+        }
+        memcpy(out + written, pos, n);
+        pos += n;
+        literal -= n;
+        written += n;
+        continue;
+      }
+
+      if (pos >= end) {
+        failed = true;
+        break;
+      }
+      uint8_t control = *pos++;
+      if (control < 128) {
+        literal = control + 1;
+      } else if (control > 128) {
+        if (pos >= end) {
+          failed = true;
+          break;
+        }
+        repeat = 257 - control;
+        value = *pos++;
+      }
+    }
+    return written;
+  }
+
+private:
+  const uint8_t* pos;
+  const uint8_t* end;
+  size_t literal;
+  size_t repeat;
+  uint8_t value;
+  bool failed;
+};
+
+/**
+ * Decodes a PackBits-compressed row-major bitmap straight into the
+ * framebuffer, 8 rows at a time
+ * Only one band (at most 8 * RLE_MAX_STRIDE bytes, on the stack) is ever
+ * decompressed; the full bitmap never exists in memory.
+ *
+ * @param buffer SSD1306 framebuffer (display.getBuffer())
+ * @param bufferWidth Framebuffer width in pixels
+ * @param bufferHeight Framebuffer height in pixels (multiple of 8)
+ * @param x Destination x (may be negative)
+ * @param y Destination y (may be negative)
+ * @param data Compressed bitmap
+ * @param length Length of the compressed data in bytes
+ * @param width Bitmap width in pixels
+ * @param height Bitmap height in pixels
+ * @param mode How the bitmap is combined with the framebuffer
+ * @param touchedBands If set, receives one bit per 8-row band that had any
+ *        set pixel (bit 0 = top band). With BLIT_OR and BLIT_XOR, empty
+ *        bands are not drawn at all, which makes sparse XOR patches cheap.
+ * @return false if the stream was too short or malformed (the bands decoded
+ *         so far have been drawn)
+ */
+bool blitRleBitmap(
+  uint8_t* buffer,
+  int bufferWidth,
+  int bufferHeight,
+  int x,
+  int y,
+  const uint8_t* data,
+  size_t length,
+  int width,
+  int height,
+  BlitMode mode,
+  uint32_t* touchedBands = nullptr
+) {
+  size_t stride = (width + 7) / 8;
+  if (stride == 0 || stride > RLE_MAX_STRIDE) {
+    return false;
+  }
+
+  uint8_t band[8 * RLE_MAX_STRIDE];
+  RleDecoder decoder(data, length);
+  if (touchedBands != nullptr) {
+    *touchedBands = 0;
+  }
+
+  for (int row = 0; row < height; row += 8) {
+    int rowCount = min(8, height - row);
+    size_t bandSize = stride * rowCount;
+    if (decoder.read(band, bandSize) != bandSize) {
+      return false;
+    }
+
+    bool empty = true;
+    for (size_t i = 0; i < bandSize && empty; i++) {
+      empty = band[i] == 0;
+    }
+    if (empty && mode != BLIT_OVERWRITE) {
+      continue;
+    }
+    if (touchedBands != nullptr && !empty) {
+      *touchedBands |= 1UL << (row / 8);
+    }
+    blitBand(buffer, bufferWidth, bufferHeight, x, y + row, band, stride, width, rowCount, mode);
+  }
+  return true;
+}
+
+#endif // SPRITE_CODEC_H
@@ -0,0 +1,314 @@
+#ifndef SYSTEM_INFO_H
+#define SYSTEM_INFO_H
+
+#include "nami_display.h"
+#include "json_stream.h"
+#include "render_queue.h"
+#include "log.h"
+
+/**
+ * Incremental system info screen
+ *
+ * The network task keeps the latest SystemInfo and the six display lines
+ * formatted from it. Updates only republish the lines whose text changed,
+ * and the render task redraws just those lines, so only the touched pages
+ * are flushed to the panel.
+ *
+ * Updates arrive as "info" WebSocket messages (a full snapshot right after
+ * subscribing, then only the fields that changed), or from the /info
+ * endpoint when the server does not support the subscription.
+ */
+
+/**
+ * /info?profile=nami record (little endian, 64 bytes), shared with
+ * apps/server/src/device/infoStream.ts:
+ *   0  version    (INFO_PROFILE_VERSION)
+ *   1  cores      (uint8)
+ *   2  mhz        (uint16)
+ *   4  ramUsed    (uint32, MB)
+ *   8  ramTotal   (uint32, MB)
+ *  12  uptime     (uint32, minutes)
+ *  16  hostname   (16 bytes, NUL padded)
+ *  32  platform   (16 bytes, NUL padded)
+ *  48  ip         (16 bytes, NUL padded)
+ */
+#define INFO_PROFILE_VERSION 1
+#define INFO_PROFILE_SIZE 64
+
+#define INFO_LINE_COUNT 6
+#define INFO_LINE_LENGTH 22  // 21 characters at text size 1, plus NUL
+#define INFO_LINE_HEIGHT 8
+
+enum InfoLine {
+  INFO_HOSTNAME,
+  INFO_PLATFORM,
+  INFO_CPU,
+  INFO_RAM,
+  INFO_UPTIME,
+  INFO_IP,
+};
+
+struct SystemInfo {
+  char hostname[17];
+  char platform[17];
+  long cores;
+  long speed;        // MHz
+  long ramUsed;      // MB
+  long ramTotal;     // MB
+  long uptime;       // Minutes
+  char ip[17];
+  uint8_t known;     // Bit per InfoLine once one of its fields was received
+};
+
+// Owned by the network task
+SystemInfo systemInfo;
+char systemInfoLines[INFO_LINE_COUNT][INFO_LINE_LENGTH];
+
+// Set while the server is pushing "info" messages
+bool infoStreamActive = false;
+
+/**
+ * Clamps a value reported by the server for display
+ * Keeps every formatted line within INFO_LINE_LENGTH whatever it sends.
+ * @return value limited to [0, limit]
+ */
+inline int clampInfoValue(long value, int limit) {
+  return value < 0 ? 0 : value > limit ? limit : (int)value;
+}
+
+/**
+ * Formats one display line from the current system info
+ * @param info System info to format
+ * @param line Which line to format
+ * @param out Output buffer of INFO_LINE_LENGTH bytes
+ */
+void formatInfoLine(const SystemInfo& info, int line, char* out) {
+  out[0] = '\0';
+  if (!(info.known & (1 << line))) {
+    return;
+  }
+
+  switch (line) {
+    case INFO_HOSTNAME:
+      snprintf(out, INFO_LINE_LENGTH, "%s", info.hostname);
+      break;
+    case INFO_PLATFORM:
+      snprintf(out, INFO_LINE_LENGTH, "%s", info.platform);
+      break;
+    case INFO_CPU:
+      snprintf(out, INFO_LINE_LENGTH, "CPU: %dC @ %dMHz",
+               clampInfoValue(info.cores, 999), clampInfoValue(info.speed, 99999));
+      break;
+    case INFO_RAM:
+      snprintf(out, INFO_LINE_LENGTH, "RAM: %d/%dMB",
+               clampInfoValue(info.ramUsed, 999999), clampInfoValue(info.ramTotal, 999999));
+      break;
+    case INFO_UPTIME:
+      snprintf(out, INFO_LINE_LENGTH, "Up: %dh %dm",
+               clampInfoValue(info.uptime / 60, 99999), clampInfoValue(info.uptime % 60, 59));
+      break;
+    case INFO_IP:
+      snprintf(out, INFO_LINE_LENGTH, "%s", info.ip);
+      break;
+  }
+}
+
+/**
+ * Reformats the info lines and queues the ones that changed
+ * @param full true to queue the whole screen (it replaces whatever is shown),
+ *             false to queue a patch that only applies if the info screen is up
+ * @return mask of the lines that changed
+ */
+uint16_t publishSystemInfo(bool full) {
+  uint16_t changed = 0;
+  for (int i = 0; i < INFO_LINE_COUNT; i++) {
+    char line[INFO_LINE_LENGTH];
+    formatInfoLine(systemInfo, i, line);
+    if (strcmp(line, systemInfoLines[i]) != 0) {
+      strcpy(systemInfoLines[i], line);
+      changed |= 1 << i;
+    }
+  }
+
+  if (!full && changed == 0) {
+    return 0;
+  }
+
+  RenderFrame* frame = beginRenderFrame(full ? RENDER_SYSTEM_INFO : RENDER_INFO_PATCH);
+  if (frame == nullptr) {
+    return changed;
+  }
+  frame->id = full ? (1 << INFO_LINE_COUNT) - 1 : changed;
+  frame->length = sizeof(systemInfoLines);
+  memcpy(frame->data, systemInfoLines, sizeof(systemInfoLines));
+  commitRenderFrame();
+  return changed;
+}
+
+/**
+ * Copies a NUL padded field of the info profile into a C string
+ */
+void readProfileString(const uint8_t* field, char* out, size_t outSize) {
+  size_t n = 0;
+  while (n < 16 && n < outSize - 1 && field[n] != '\0') {
+    out[n] = (char)field[n];
+    n++;
+  }
+  out[n] = '\0';
+}
+
+/**
+ * Decodes an /info?profile=nami record
+ * Fixed offsets, no parsing: cost and memory do not depend on the host.
+ * @param data Response body
+ * @param length Length of the body in bytes
+ * @param info System info to fill (left untouched on failure)
+ * @return true if the record was valid
+ */
+bool decodeInfoProfile(const uint8_t* data, size_t length, SystemInfo& info) {
+  if (length < INFO_PROFILE_SIZE || data[0] != INFO_PROFILE_VERSION) {
+    return false;
+  }
+
+  info.cores = data[1];
+  info.speed = data[2] | (data[3] << 8);
+  info.ramUsed = (long)(data[4] | (data[5] << 8) | (data[6] << 16) | ((uint32_t)data[7] << 24));
+  info.ramTotal = (long)(data[8] | (data[9] << 8) | (data[10] << 16) | ((uint32_t)data[11] << 24));
+  info.uptime = (long)(data[12] | (data[13] << 8) | (data[14] << 16) | ((uint32_t)data[15] << 24));
+  readProfileString(data + 16, info.hostname, sizeof(info.hostname));
+  readProfileString(data + 32, info.platform, sizeof(info.platform));
+  readProfileString(data + 48, info.ip, sizeof(info.ip));
+
+  info.known = (1 << INFO_LINE_COUNT) - 1;
+  if (info.ip[0] == '\0') {
+    info.known &= ~(1 << INFO_IP);
+  }
+  return true;
+}
+
+/**
+ * Applies an "info" WebSocket message to the system info
+ * Expected JSON format (every field optional except type):
+ * {"type":"info","full":1,"host":"raspberrypi","os":"linux","cores":4,"mhz":1800,
+ *  "ramUsed":412,"ramTotal":3792,"upMin":1234,"ip":"192.168.1.20"}
+ *
+ * @param json JSON text (not necessarily null terminated)
+ * @param length Length of the JSON text in bytes
+ * @return true if this was an info message, false otherwise
+ */
+bool applyInfoMessage(const char* json, size_t length) {
+  if (!looksLikeJsonObject(json, length)) {
+    return false;
+  }
+
+  JsonStream stream(json, length);
+  char key[12];
+  char type[8];
+
+  // The server always sends "type" first
+  if (!stream.beginObject() || !stream.nextKey(key, sizeof(key)) || strcmp(key, "type") != 0 ||
+      !stream.readString(type, sizeof(type)) || strcmp(type, "info") != 0) {
+    return false;
+  }
+
+  SystemInfo update = systemInfo;
+  long full = 0;
+
+  while (stream.nextKey(key, sizeof(key))) {
+    if (strcmp(key, "full") == 0) {
+      stream.readInt(full);
+      if (full) {
+        update.known = 0;
+      }
+    } else if (strcmp(key, "host") == 0) {
+      stream.readString(update.hostname, sizeof(update.hostname));
+      update.known |= 1 << INFO_HOSTNAME;
+    } else if (strcmp(key, "os") == 0) {
+      stream.readString(update.platform, sizeof(update.platform));
+      update.known |= 1 << INFO_PLATFORM;
+    } else if (strcmp(key, "cores") == 0) {
+      stream.readInt(update.cores);
+      update.known |= 1 << INFO_CPU;
+    } else if (strcmp(key, "mhz") == 0) {
+      stream.readInt(update.speed);
+      update.known |= 1 << INFO_CPU;
+    } else if (strcmp(key, "ramUsed") == 0) {
+      stream.readInt(update.ramUsed);
+      update.known |= 1 << INFO_RAM;
+    } else if (strcmp(key, "ramTotal") == 0) {
+      stream.readInt(update.ramTotal);
+      update.known |= 1 << INFO_RAM;
+    } else if (strcmp(key, "upMin") == 0) {
+      stream.readInt(update.uptime);
+      update.known |= 1 << INFO_UPTIME;
+    } else if (strcmp(key, "ip") == 0) {
+      stream.readString(update.ip, sizeof(update.ip));
+      update.known |= 1 << INFO_IP;
+    } else {
+      stream.skipValue();
+    }
+  }
+
+  if (stream.error()) {
+    LOG_WARN("Info", "Malformed info message");
+    return true;
+  }
+
+  systemInfo = update;
+  infoStreamActive = true;
+  uint16_t changed = publishSystemInfo(full != 0);
+
+  LOG_INFO("Info", "%s, changed lines: 0x%X", full ? "Snapshot" : "Update", (unsigned)changed);
+  return true;
+}
+
+/**
+ * Draws one info line, clearing what was there before
+ */
+void drawInfoLine(NamiDisplay& display, int line, const char* text) {
+  int yPos = line * INFO_LINE_HEIGHT;
+  display.fillRect(0, yPos, display.width(), INFO_LINE_HEIGHT, SSD1306_BLACK);
+  display.setCursor(0, yPos);
+  display.print(text);
+}
+
+/**
+ * Draws the whole system info screen
+ * @param display Reference to the NamiDisplay object
+ * @param lines INFO_LINE_COUNT lines of INFO_LINE_LENGTH bytes
+ */
+void displaySystemInfo(NamiDisplay& display, const char (*lines)[INFO_LINE_LENGTH]) {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  for (int i = 0; i < INFO_LINE_COUNT; i++) {
+    display.setCursor(0, i * INFO_LINE_HEIGHT);
+    display.print(lines[i]);
+  }
+
+  display.display();
+}
+
+/**
+ * Redraws only the changed lines of the system info screen
+ * The caller must make sure the info screen is the one being shown.
+ * @param display Reference to the NamiDisplay object
+ * @param lines INFO_LINE_COUNT lines of INFO_LINE_LENGTH bytes
+ * @param changed Mask of the lines to redraw
+ */
+void patchSystemInfo(NamiDisplay& display, const char (*lines)[INFO_LINE_LENGTH], uint16_t changed) {
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  for (int i = 0; i < INFO_LINE_COUNT; i++) {
+    if (changed & (1 << i)) {
+      drawInfoLine(display, i, lines[i]);
+    }
+  }
+
+  // Dirty tracking limits the flush to the pages of the redrawn lines
+  display.display();
+}
+
+#endif // SYSTEM_INFO_H
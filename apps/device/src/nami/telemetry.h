@@ -0,0 +1,231 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "nami_display.h"
+#include "json_stream.h"
+#include "render_queue.h"
+
+/**
+ * Hot-path telemetry
+ *
+ * Every server message that reaches the screen leaves one timing sample
+ * (micros()): received, parsed into a render frame, picked up by the render
+ * task, drawn (flush started) and flushed. The render task pushes samples
+ * into a fixed-size SPSC ring, the same queue as the render frames; the
+ * network task drains it every TELEMETRY_REPORT_INTERVAL and sends the
+ * latency percentiles, with heap, stack, reconnect and RSSI gauges, as a
+ * "metrics" message, which the server forwards to the web clients.
+ *
+ * Recording a sample is a few stores; nothing is logged or formatted on
+ * the hot path. Samples that do not fit in the ring before the next report
+ * are counted as dropped.
+ *
+ * End-to-end tracing: a server that saw "trace":1 in the identify message
+ * sends {"type":"trace","id":N,"ts":T} right before each display message.
+ * The next message is tagged with that trace, and once it is on screen the
+ * network task answers {"type":"trace_ack","id":N,"ts":T,...} with the
+ * parse, render and flush offsets from its arrival, in microseconds. T is
+ * the server's own clock, only echoed back.
+ */
+
+#define TELEMETRY_RING_DEPTH 64
+#define TELEMETRY_REPORT_INTERVAL 30000  // Milliseconds between metrics messages
+#define TRACE_RING_DEPTH 8
+
+struct TelemetrySample {
+  RenderKind kind;
+  uint32_t receivedAt;  // WebSocket message received
+  uint32_t parsedAt;    // Render frame committed
+  uint32_t dequeuedAt;  // Render task started drawing
+  uint32_t renderedAt;  // Drawing done, flush started
+  uint32_t flushedAt;   // Flush done
+};
+
+struct TraceAck {
+  uint32_t id;
+  uint32_t ts;
+  uint32_t parseUs;   // Offsets from the arrival of the message
+  uint32_t renderUs;
+  uint32_t flushUs;
+};
+
+enum TelemetryStage : uint8_t {
+  STAGE_PARSE,   // received -> parsed
+  STAGE_QUEUE,   // parsed -> dequeued
+  STAGE_RENDER,  // dequeued -> rendered
+  STAGE_FLUSH,   // rendered -> flushed
+  STAGE_TOTAL,   // received -> flushed
+  STAGE_COUNT,
+};
+
+/**
+ * Percentiles of one stage over a report window, in microseconds
+ */
+struct StageSummary {
+  unsigned p50;  // Plain unsigned, so it prints with %u on every toolchain
+  unsigned p95;
+  unsigned max;
+};
+
+// Render task -> network task
+SpscQueue<TelemetrySample, TELEMETRY_RING_DEPTH> telemetryRing;
+SpscQueue<TraceAck, TRACE_RING_DEPTH> traceRing;
+
+// Trace announced for the next message (network task only)
+uint32_t nextTraceId = 0;
+uint32_t nextTraceTs = 0;
+
+// Connection counters (network task only)
+uint32_t webSocketConnects = 0;
+uint32_t webSocketDisconnects = 0;
+
+/**
+ * Records the timing of a frame the render task just drew, and queues the
+ * trace ack if the server traced it
+ * Frames the device queued itself (status screens) are not recorded.
+ * Render task only.
+ * @param display Reference to the NamiDisplay object
+ * @param frame Frame that was drawn
+ * @param dequeuedAt micros() before drawing started
+ */
+void recordFrameTiming(const NamiDisplay& display, const RenderFrame& frame, uint32_t dequeuedAt) {
+  if (frame.receivedAt == 0) {
+    return;
+  }
+
+  // Flushes are sent in the background; pixels are there once it is done
+  display.waitForFlush();
+  uint32_t now = micros();
+  // Drawing ended where the last flush started, if it flushed at all
+  uint32_t flushStart = display.flushStartedAt();
+  uint32_t renderedAt = flushStart - dequeuedAt <= now - dequeuedAt ? flushStart : now;
+
+  TelemetrySample* sample = telemetryRing.beginPush();
+  if (sample != nullptr) {
+    sample->kind = frame.kind;
+    sample->receivedAt = frame.receivedAt;
+    sample->parsedAt = frame.parsedAt;
+    sample->dequeuedAt = dequeuedAt;
+    sample->renderedAt = renderedAt;
+    sample->flushedAt = now;
+    telemetryRing.commitPush();
+  }
+
+  if (frame.traceId == 0) {
+    return;
+  }
+  TraceAck* ack = traceRing.beginPush();
+  if (ack != nullptr) {
+    ack->id = frame.traceId;
+    ack->ts = frame.traceTs;
+    ack->parseUs = frame.parsedAt - frame.receivedAt;
+    ack->renderUs = renderedAt - frame.receivedAt;
+    ack->flushUs = now - frame.receivedAt;
+    traceRing.commitPush();
+  }
+}
+
+/**
+ * Takes the trace announcement for the next message
+ * Network task only.
+ * @param json Text message
+ * @param length Length of the message in bytes
+ * @return true if this was a trace message
+ */
+bool applyTraceMessage(const char* json, size_t length) {
+  if (!looksLikeJsonObject(json, length)) {
+    return false;
+  }
+
+  JsonStream stream(json, length);
+  char key[8];
+  char type[8];
+
+  // The server always sends "type" first
+  if (!stream.beginObject() || !stream.nextKey(key, sizeof(key)) || strcmp(key, "type") != 0 ||
+      !stream.readString(type, sizeof(type)) || strcmp(type, "trace") != 0) {
+    return false;
+  }
+
+  long id = 0;
+  long ts = 0;
+  while (stream.nextKey(key, sizeof(key))) {
+    if (strcmp(key, "id") == 0) {
+      stream.readInt(id);
+    } else if (strcmp(key, "ts") == 0) {
+      stream.readInt(ts);
+    } else {
+      stream.skipValue();
+    }
+  }
+  nextTraceId = stream.error() ? 0 : (uint32_t)id;
+  nextTraceTs = (uint32_t)ts;
+  return true;
+}
+
+/**
+ * @return duration of one stage of a sample
+ */
+inline uint32_t stageDuration(const TelemetrySample& sample, TelemetryStage stage) {
+  switch (stage) {
+    case STAGE_PARSE: return sample.parsedAt - sample.receivedAt;
+    case STAGE_QUEUE: return sample.dequeuedAt - sample.parsedAt;
+    case STAGE_RENDER: return sample.renderedAt - sample.dequeuedAt;
+    case STAGE_FLUSH: return sample.flushedAt - sample.renderedAt;
+    default: return sample.flushedAt - sample.receivedAt;
+  }
+}
+
+/**
+ * Computes the percentiles of one stage
+ * @param samples Samples drained from the ring
+ * @param count Number of samples
+ * @param stage Stage to summarize
+ * @param scratch Room for count durations
+ */
+StageSummary summarizeStage(const TelemetrySample* samples, int count, TelemetryStage stage, uint32_t* scratch) {
+  StageSummary summary = {0, 0, 0};
+  if (count == 0) {
+    return summary;
+  }
+
+  // Insertion sort, the window is small
+  for (int i = 0; i < count; i++) {
+    uint32_t value = stageDuration(samples[i], stage);
+    int j = i;
+    for (; j > 0 && scratch[j - 1] > value; j--) {
+      scratch[j] = scratch[j - 1];
+    }
+    scratch[j] = value;
+  }
+
+  summary.p50 = scratch[(count - 1) * 50 / 100];
+  summary.p95 = scratch[(count - 1) * 95 / 100];
+  summary.max = scratch[count - 1];
+  return summary;
+}
+
+/**
+ * Drains the ring and summarizes every stage
+ * Network task only.
+ * @param stages Receives STAGE_COUNT summaries
+ * @return number of samples in the window
+ */
+int drainTelemetry(StageSummary* stages) {
+  static TelemetrySample samples[TELEMETRY_RING_DEPTH];
+  static uint32_t scratch[TELEMETRY_RING_DEPTH];
+
+  int count = 0;
+  TelemetrySample* sample;
+  while (count < TELEMETRY_RING_DEPTH && (sample = telemetryRing.front()) != nullptr) {
+    samples[count++] = *sample;
+    telemetryRing.pop();
+  }
+
+  for (int stage = 0; stage < STAGE_COUNT; stage++) {
+    stages[stage] = summarizeStage(samples, count, (TelemetryStage)stage, scratch);
+  }
+  return count;
+}
+
+#endif // TELEMETRY_H
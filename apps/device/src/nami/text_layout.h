@@ -0,0 +1,159 @@
+#ifndef TEXT_LAYOUT_H
+#define TEXT_LAYOUT_H
+
+#include "nami_display.h"
+
+/**
+ * Text layout for the built-in 5x7 GFX font
+ *
+ * The classic Adafruit font is fixed width: every glyph occupies a 6x8 cell
+ * (5x7 plus one pixel of spacing) times the text size. Line widths are
+ * therefore plain arithmetic, so centering never needs getTextBounds(), and
+ * wrapping, clipping and truncation are computed in one pass over a
+ * const char* range. Lines point into the source text; nothing is copied
+ * or allocated.
+ */
+
+#define TEXT_GLYPH_WIDTH 6    // Pixels per character at text size 1, spacing included
+#define TEXT_LINE_HEIGHT 8    // Pixels per line at text size 1
+#define TEXT_SCREEN_WIDTH 128
+#define TEXT_COLUMNS (TEXT_SCREEN_WIDTH / TEXT_GLYPH_WIDTH)  // 21 characters per line
+#define TEXT_MAX_LINES 8      // 64 pixels / 8 pixels per line
+
+enum TextWrap : uint8_t {
+  TEXT_WRAP_WORDS,  // Break at the last space that fits, or mid-word if there is none
+  TEXT_WRAP_CHARS,  // Break exactly at the column limit
+  TEXT_CLIP,        // One line per '\n', characters past the column limit are dropped
+};
+
+struct TextLine {
+  const char* text;  // Points into the laid out text
+  uint8_t length;
+};
+
+struct TextLayout {
+  TextLine lines[TEXT_MAX_LINES];
+  uint8_t count;
+  bool truncated;  // Some text did not fit in maxLines
+};
+
+/**
+ * @return width in pixels of length characters
+ */
+inline int textWidth(size_t length, uint8_t size = 1) {
+  return (int)length * TEXT_GLYPH_WIDTH * size;
+}
+
+/**
+ * @return x coordinate that centers length characters on the screen
+ */
+inline int textCenterX(size_t length, uint8_t size = 1) {
+  return max((TEXT_SCREEN_WIDTH - textWidth(length, size)) / 2, 0);
+}
+
+/**
+ * Finds the end of the screen line starting at pos
+ * '\n' always ends a line. Spaces at a word wrap are dropped.
+ *
+ * @param text Text to lay out (not necessarily null terminated)
+ * @param length Length of the text in bytes
+ * @param pos Offset of the first character of the line
+ * @param columns Maximum characters per line (at most 255)
+ * @param wrap How lines longer than columns are handled
+ * @param lineLength Output number of characters on the line
+ * @return offset where the next line starts
+ */
+size_t nextTextLine(const char* text, size_t length, size_t pos, int columns, TextWrap wrap, uint8_t& lineLength) {
+  size_t limit = min(length, pos + columns);
+  size_t end = pos;
+  size_t lastSpace = pos;
+  while (end < limit && text[end] != '\n') {
+    if (text[end] == ' ') {
+      lastSpace = end;
+    }
+    end++;
+  }
+
+  size_t next = end;
+  if (end < length && text[end] == '\n') {
+    next = end + 1;
+  } else if (end < length) {
+    // The line is full and the text goes on
+    if (wrap == TEXT_CLIP) {
+      const char* newline = (const char*)memchr(text + end, '\n', length - end);
+      next = newline ? (size_t)(newline - text) + 1 : length;
+    } else if (wrap == TEXT_WRAP_WORDS) {
+      if (text[end] == ' ') {
+        next = end + 1;
+      } else if (lastSpace > pos) {
+        end = lastSpace;
+        next = lastSpace + 1;
+      }
+    }
+  }
+
+  lineLength = (uint8_t)(end - pos);
+  return next;
+}
+
+/**
+ * Splits text into screen lines
+ *
+ * @param text Text to lay out (not necessarily null terminated)
+ * @param length Length of the text in bytes
+ * @param columns Maximum characters per line (at most 255)
+ * @param maxLines Maximum number of lines (at most TEXT_MAX_LINES)
+ * @param wrap How lines longer than columns are handled
+ * @param layout Output lines
+ * @return number of lines
+ */
+int layoutText(const char* text, size_t length, int columns, int maxLines, TextWrap wrap, TextLayout& layout) {
+  maxLines = min(maxLines, TEXT_MAX_LINES);
+  layout.count = 0;
+
+  size_t pos = 0;
+  while (pos < length && layout.count < maxLines) {
+    TextLine& line = layout.lines[layout.count];
+    line.text = text + pos;
+    pos = nextTextLine(text, length, pos, columns, wrap, line.length);
+    layout.count++;
+  }
+
+  layout.truncated = pos < length;
+  return layout.count;
+}
+
+/**
+ * Shortens text in place to at most columns characters, ending with "..."
+ * when something was cut
+ * @param text Text buffer (must hold length characters)
+ * @param length Length of the text in bytes
+ * @param columns Maximum number of characters (at least 3)
+ * @return new length
+ */
+size_t truncateText(char* text, size_t length, size_t columns) {
+  if (length <= columns) {
+    return length;
+  }
+  memcpy(text + columns - 3, "...", 3);
+  return columns;
+}
+
+/**
+ * Draws length characters of text starting at (x, y)
+ */
+void drawTextLine(NamiDisplay& display, int x, int y, const char* text, size_t length) {
+  display.setCursor(x, y);
+  for (size_t i = 0; i < length; i++) {
+    display.write((uint8_t)text[i]);
+  }
+}
+
+/**
+ * Draws length characters of text centered horizontally at height y
+ */
+void drawCenteredLine(NamiDisplay& display, int y, const char* text, size_t length) {
+  drawTextLine(display, textCenterX(length), y, text, length);
+}
+
+#endif // TEXT_LAYOUT_H
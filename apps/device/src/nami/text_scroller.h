@@ -0,0 +1,208 @@
+#ifndef TEXT_SCROLLER_H
+#define TEXT_SCROLLER_H
+
+#include "nami_display.h"
+#include "render_queue.h"
+#include "text_layout.h"
+#include "log.h"
+
+/**
+ * Scrolling viewer for messages and ASCII art longer than the screen
+ *
+ * Text that does not fit is copied out of the render queue and indexed
+ * once: every screen line is a 4 byte entry (offset, length, x) into the
+ * copy, so the whole text stays available instead of ending in "...".
+ *
+ * Lines sit on the 8 pixel pages, content line L always living in RAM page
+ * L % 8. Scrolling moves the controller's display start line one pixel row
+ * at a time: the RAM row that just left the top of the screen reappears at
+ * the bottom, so a step only rewrites that one row (one bit of one page)
+ * with the line coming in. Each step sends at most one page window plus a
+ * command, and the incoming line is drawn once every 8 steps.
+ *
+ * Runs on the render task only.
+ */
+
+#define SCROLL_MAX_LINES 256
+#define SCROLL_SCREEN_LINES (64 / TEXT_LINE_HEIGHT)
+#define SCROLL_MESSAGE_LINES 6     // Message lines shown without scrolling
+#define SCROLL_STEP_INTERVAL 40    // Milliseconds per pixel row
+#define SCROLL_HOLD_TIME 2000      // Milliseconds paused at the top and at the bottom
+
+#define SCROLL_MESSAGE_HEADER "Message:"
+#define SCROLL_MESSAGE_HEADER_LENGTH (sizeof(SCROLL_MESSAGE_HEADER) - 1)
+
+enum ScrollStyle : uint8_t {
+  SCROLL_MESSAGE,    // "Message:" header, then word wrapped and centered
+  SCROLL_ASCII_ART,  // Wrapped at the column limit, left aligned
+};
+
+struct ScrollLine {
+  uint16_t offset;  // Start of the line in TextScroller::text
+  uint8_t length;
+  uint8_t x;
+};
+
+struct TextScroller {
+  bool active;
+  char text[SCROLL_MESSAGE_HEADER_LENGTH + RENDER_FRAME_CAPACITY];
+  ScrollLine lines[SCROLL_MAX_LINES];
+  uint16_t lineCount;
+  uint16_t scrollY;                     // Pixel rows scrolled past the top
+  uint32_t nextStepAt;                  // millis() of the next step
+  uint8_t incoming[TEXT_SCREEN_WIDTH];  // Line entering at the bottom, as one page
+};
+
+TextScroller textScroller;
+
+/**
+ * Draws one content line into its RAM page (blank past the end of the text)
+ * @param display Reference to the NamiDisplay object
+ * @param index Content line
+ */
+void drawScrollLine(NamiDisplay& display, int index) {
+  const TextScroller& scroller = textScroller;
+  int y = (index % SCROLL_SCREEN_LINES) * TEXT_LINE_HEIGHT;
+  display.fillRect(0, y, display.width(), TEXT_LINE_HEIGHT, SSD1306_BLACK);
+  if (index < scroller.lineCount) {
+    const ScrollLine& line = scroller.lines[index];
+    drawTextLine(display, line.x, y, scroller.text + line.offset, line.length);
+  }
+}
+
+/**
+ * Redraws the first screen of text and holds it before scrolling
+ * @param display Reference to the NamiDisplay object
+ */
+void showScrollTop(NamiDisplay& display) {
+  TextScroller& scroller = textScroller;
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+  for (int i = 0; i < SCROLL_SCREEN_LINES; i++) {
+    drawScrollLine(display, i);
+  }
+  display.display();
+
+  scroller.scrollY = 0;
+  scroller.nextStepAt = millis() + SCROLL_HOLD_TIME;
+}
+
+/**
+ * Shows text in the scrolling viewer if it is too long for one screen
+ * @param display Reference to the NamiDisplay object
+ * @param style Message or ASCII art layout
+ * @param text Text to show (not necessarily null terminated)
+ * @param length Length of the text in bytes
+ * @return false if the text fits on one screen; nothing is drawn then and
+ *         the caller shows it statically
+ */
+bool startTextScroll(NamiDisplay& display, ScrollStyle style, const char* text, size_t length) {
+  TextScroller& scroller = textScroller;
+  scroller.active = false;
+
+  size_t start = 0;
+  int count = 0;
+  if (style == SCROLL_MESSAGE) {
+    // Header and a blank line scroll away with the text
+    start = SCROLL_MESSAGE_HEADER_LENGTH;
+    memcpy(scroller.text, SCROLL_MESSAGE_HEADER, start);
+    scroller.lines[count++] = { 0, (uint8_t)start, (uint8_t)textCenterX(start) };
+    scroller.lines[count++] = { 0, 0, 0 };
+  }
+  int headerLines = count;
+
+  length = min(length, (size_t)RENDER_FRAME_CAPACITY);
+  memcpy(scroller.text + start, text, length);
+  size_t end = start + length;
+  TextWrap wrap = style == SCROLL_MESSAGE ? TEXT_WRAP_WORDS : TEXT_WRAP_CHARS;
+
+  size_t pos = start;
+  while (pos < end && count < SCROLL_MAX_LINES) {
+    ScrollLine& line = scroller.lines[count++];
+    line.offset = (uint16_t)pos;
+    pos = nextTextLine(scroller.text, end, pos, TEXT_COLUMNS, wrap, line.length);
+    line.x = style == SCROLL_MESSAGE ? (uint8_t)textCenterX(line.length) : 0;
+  }
+
+  int fit = style == SCROLL_MESSAGE ? SCROLL_MESSAGE_LINES : SCROLL_SCREEN_LINES;
+  if (count - headerLines <= fit && pos >= end) {
+    return false;
+  }
+
+  scroller.lineCount = count;
+  scroller.active = true;
+  if (pos < end) {
+    LOG_INFO("Scroll", "%d lines (%u bytes beyond the line limit dropped)", (int)count, (unsigned)(end - pos));
+  } else {
+    LOG_INFO("Scroll", "%d lines", (int)count);
+  }
+
+  showScrollTop(display);
+  return true;
+}
+
+/**
+ * Stops scrolling (another screen replaced the text)
+ */
+void stopTextScroll() {
+  textScroller.active = false;
+}
+
+/**
+ * Scrolls one pixel row if a step is due
+ * @param display Reference to the NamiDisplay object
+ * @return milliseconds until the next step, or portMAX_DELAY when nothing
+ *         is scrolling
+ */
+uint32_t serviceTextScroll(NamiDisplay& display) {
+  TextScroller& scroller = textScroller;
+  if (!scroller.active) {
+    return portMAX_DELAY;
+  }
+
+  int32_t wait = (int32_t)(scroller.nextStepAt - millis());
+  if (wait > 0) {
+    return wait;
+  }
+
+  int maxScroll = (scroller.lineCount - SCROLL_SCREEN_LINES) * TEXT_LINE_HEIGHT;
+  if (scroller.scrollY >= maxScroll) {
+    // Held at the bottom long enough, start over
+    showScrollTop(display);
+    return SCROLL_HOLD_TIME;
+  }
+
+  int width = display.width();
+  int row = scroller.scrollY % TEXT_LINE_HEIGHT;
+  int page = (scroller.scrollY / TEXT_LINE_HEIGHT) % SCROLL_SCREEN_LINES;
+  uint8_t* pageData = display.getBuffer() + page * width;
+
+  if (row == 0) {
+    // The top page starts turning into the line 8 below it. Draw that line
+    // in place to get its page bytes, then put the visible line back before
+    // anything is flushed.
+    uint8_t outgoing[TEXT_SCREEN_WIDTH];
+    memcpy(outgoing, pageData, width);
+    drawScrollLine(display, scroller.scrollY / TEXT_LINE_HEIGHT + SCROLL_SCREEN_LINES);
+    memcpy(scroller.incoming, pageData, width);
+    memcpy(pageData, outgoing, width);
+  }
+
+  // The top row of the screen moves to the bottom: give it the incoming row
+  uint8_t bit = 1 << row;
+  for (int x = 0; x < width; x++) {
+    pageData[x] = (pageData[x] & ~bit) | (scroller.incoming[x] & bit);
+  }
+  display.markDirty(0, page * TEXT_LINE_HEIGHT + row, width, 1);
+
+  scroller.scrollY++;
+  display.setStartLine(scroller.scrollY % display.height());
+  display.display();
+
+  uint32_t delay = scroller.scrollY >= maxScroll ? SCROLL_HOLD_TIME : SCROLL_STEP_INTERVAL;
+  scroller.nextStepAt = millis() + delay;
+  return delay;
+}
+
+#endif // TEXT_SCROLLER_H
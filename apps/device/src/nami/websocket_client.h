@@ -2,519 +2,510 @@
 #define WEBSOCKET_CLIENT_H
 
 #include <WebSocketsClient.h>
-#include <HTTPClient.h>
-#include <ArduinoJson.h>
-#include <Adafruit_SSD1306.h>
+#include "nami_display.h"
 #include "wifi_connection.h"
 #include "pokemon_display.h"
-
+#include "async_http.h"
+#include "system_info.h"
+#include "sprite_cache.h"
+#include "animation_player.h"
+#include "text_layout.h"
+#include "message_arena.h"
+#include "telemetry.h"
+#include "event_loop.h"
+#include "log.h"
+
+// Overridable at build time (the host simulation points them at localhost)
+#ifndef WEBSOCKET_HOST
 #define WEBSOCKET_HOST "raspberrypi.local"
+#endif
+#ifndef WEBSOCKET_PORT
 #define WEBSOCKET_PORT 3000
+#endif
 #define WEBSOCKET_PATH "/"
-#define INFO_ENDPOINT "http://raspberrypi.local:3000/info"
+#define INFO_PATH "/info?profile=nami"  // Fixed binary record, see system_info.h
+#define INFO_TIMEOUT 10000  // Whole request, connect included (ms)
+#define WEBSOCKET_HEARTBEAT_INTERVAL 15000  // Ping period (ms)
+#define WEBSOCKET_PONG_TIMEOUT 3000         // Wait for each pong (ms)
+#define WEBSOCKET_MISSED_PONGS 2            // Missed pongs before disconnecting
+
+#define WEBSOCKET_TEXT_CAPACITY 576  // Longest text message the device sends (metrics, ~540 bytes at worst)
+
+/**
+ * WebSocketsClient that exposes its transport, so the network loop can
+ * sleep in select() on the socket (see event_loop.h)
+ */
+class NamiWebSocketsClient : public WebSocketsClient {
+public:
+  /**
+   * @return socket descriptor, -1 while there is no connection
+   */
+  int fd() {
+    return _client.tcp != nullptr && _client.tcp->connected() ? _client.tcp->fd() : -1;
+  }
+
+  /**
+   * @return true if received data is waiting in the client's own buffer,
+   *         where select() cannot see it
+   */
+  bool hasBufferedData() {
+    return _client.tcp != nullptr && _client.tcp->available() > 0;
+  }
+
+  /**
+   * Lets the next loop() make one connect attempt, and no other until the
+   * reconnect interval has passed
+   * The library connects once millis() - _lastConnectionFail reaches the
+   * interval and sets _lastConnectionFail when a connect fails; begin()
+   * resets it to 0, which would hold the first attempt back until the
+   * interval has passed since boot.
+   */
+  void armConnect() {
+    armedFail = millis() - _reconnectInterval;
+    _lastConnectionFail = armedFail;
+  }
+
+  /**
+   * @return true if the attempt started by armConnect() is over without a
+   *         connection: the connect failed or the handshake was dropped
+   */
+  bool connectFailed() {
+    bool tcpOpen = _client.tcp != nullptr && _client.tcp->connected();
+    return !isConnected() && !tcpOpen && _lastConnectionFail != armedFail;
+  }
+
+private:
+  unsigned long armedFail = 0;
+};
 
 // Global WebSocket client instance
-WebSocketsClient webSocket;
+NamiWebSocketsClient webSocket;
+
+// In-flight /info request, polled by the network task
+AsyncHttpGet infoRequest;
+
+// Set once the info subscription was requested, so it is renewed on reconnect
+bool infoSubscribed = false;
+
+// Last frame seq acknowledged / resync requested (network task only)
+uint16_t ackedSeq = 0;
+uint16_t resyncSeq = 0;
+
+/**
+ * Formats a text message in the message arena and sends it
+ * WEBSOCKETS_MAX_HEADER_SIZE bytes are reserved in front of the text so
+ * the library writes the frame header in place; otherwise it copies every
+ * payload into a fresh heap buffer.
+ * @param format printf-style format
+ * @return true if the message was sent
+ */
+bool sendTextMessage(const char* format, ...) {
+  uint8_t* buffer = (uint8_t*)messageArena.alloc(WEBSOCKETS_MAX_HEADER_SIZE + WEBSOCKET_TEXT_CAPACITY);
+  if (buffer == nullptr) {
+    LOG_ERROR("WebSocket", "Message arena exhausted");
+    return false;
+  }
 
-// Global display reference for use in event handler
-Adafruit_SSD1306* globalDisplay = nullptr;
+  char* text = (char*)buffer + WEBSOCKETS_MAX_HEADER_SIZE;
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(text, WEBSOCKET_TEXT_CAPACITY, format, args);
+  va_end(args);
+  if (n < 0 || n >= WEBSOCKET_TEXT_CAPACITY) {
+    LOG_ERROR("WebSocket", "Outgoing message too long");
+    return false;
+  }
+  return webSocket.sendTXT(buffer, n, true);
+}
 
 /**
  * Display ASCII art on OLED screen
- * Handles line breaks and scrolling for long ASCII art
- * @param display Reference to the Adafruit_SSD1306 display object
- * @param asciiArt The ASCII art string to display
+ * Line breaks are preserved and long lines are split at the screen edge.
+ * When the art does not fit, the last line shows "..." instead.
+ * @param display Reference to the NamiDisplay object
+ * @param asciiArt The ASCII art text
+ * @param length Length of the text in bytes
  */
-void displayAsciiArt(Adafruit_SSD1306& display, const String& asciiArt) {
+void displayAsciiArt(NamiDisplay& display, const char* asciiArt, size_t length) {
+  display.clearDisplay();
+  display.setTextSize(1);
+  display.setTextColor(SSD1306_WHITE);
+
+  TextLayout layout;
+  layoutText(asciiArt, length, TEXT_COLUMNS, TEXT_MAX_LINES, TEXT_WRAP_CHARS, layout);
+
+  for (int i = 0; i < layout.count; i++) {
+    int yPos = i * TEXT_LINE_HEIGHT;
+    if (layout.truncated && i == layout.count - 1) {
+      // If there's more content, show indicator
+      drawTextLine(display, 0, yPos, "...", 3);
+    } else {
+      drawTextLine(display, 0, yPos, layout.lines[i].text, layout.lines[i].length);
+    }
+  }
+
+  display.display();
+}
+
+/**
+ * Display a chat message on OLED screen, word wrapped and centered
+ * @param display Reference to the NamiDisplay object
+ * @param message The message to display
+ * @param length Length of the message in bytes
+ */
+void displayMessage(NamiDisplay& display, const char* message, size_t length) {
+  // Display as regular message (centered)
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
   
-  // Display parameters
-  const int lineHeight = 8; // Text size 1 uses ~8 pixels per line
-  const int maxWidth = 128;
-  const int maxLines = 8; // 64 pixels / 8 pixels per line = 8 lines
-  const int charWidth = 6; // Approximate character width for text size 1
-  const int charsPerLine = maxWidth / charWidth; // ~21 characters per line
-  
-  // Split ASCII art by newlines
-  int lineCount = 0;
-  int startPos = 0;
-  int yPos = 0;
+  // Display "Message:" header (centered)
+  drawCenteredLine(display, 5, "Message:", 8);
   
-  // Process the message line by line
-  while (startPos < asciiArt.length() && lineCount < maxLines) {
-    // Find the next newline or end of string
-    int newlinePos = asciiArt.indexOf('\n', startPos);
-    int endPos = (newlinePos == -1) ? asciiArt.length() : newlinePos;
-    
-    // Extract the line
-    String line = asciiArt.substring(startPos, endPos);
-    
-    // If line is longer than display width, split it
-    while (line.length() > charsPerLine && lineCount < maxLines) {
-      String subLine = line.substring(0, charsPerLine);
-      display.setCursor(0, yPos);
-      display.println(subLine);
-      yPos += lineHeight;
-      lineCount++;
-      
-      // Remove processed part from line
-      line = line.substring(charsPerLine);
-    }
-    
-    // Display remaining part of line (if any)
-    if (line.length() > 0 && lineCount < maxLines) {
-      display.setCursor(0, yPos);
-      display.println(line);
-      yPos += lineHeight;
-      lineCount++;
-    }
-    
-    // Move to next line (skip the newline character)
-    startPos = (newlinePos == -1) ? asciiArt.length() : newlinePos + 1;
+  // Display the message, wrapping at spaces (centered)
+  const int maxLines = 6; // Leave some space
+  int yPos = 18;
+  TextLayout layout;
+  layoutText(message, length, TEXT_COLUMNS, maxLines, TEXT_WRAP_WORDS, layout);
+
+  for (int i = 0; i < layout.count; i++) {
+    drawCenteredLine(display, yPos, layout.lines[i].text, layout.lines[i].length);
+    yPos += TEXT_LINE_HEIGHT;
   }
   
-  // If there's more content, show indicator
-  if (startPos < asciiArt.length()) {
-    // Clear last line and show "..."
-    yPos -= lineHeight;
-    display.fillRect(0, yPos, maxWidth, lineHeight, SSD1306_BLACK);
-    display.setCursor(0, yPos);
-    display.println("...");
+  // If message was truncated, show "..." (centered)
+  if (layout.truncated) {
+    drawCenteredLine(display, yPos, "...", 3);
   }
   
   display.display();
 }
 
+/**
+ * Handles a binary frame: bitmaps are queued and stored in the sprite
+ * cache, show-cached frames are served from flash (or reported as a miss)
+ * @param payload Raw WebSocket binary payload
+ * @param length Payload length in bytes
+ */
+void handleBinaryFrame(const uint8_t* payload, size_t length) {
+  NamiFrame header;
+  if (!decodeFrame(payload, length, header)) {
+    LOG_WARN("WebSocket", "Invalid binary frame");
+    return;
+  }
+
+  if (header.type == FRAME_TYPE_ANIMATION) {
+    queueAnimationFrame(payload, length);
+    return;
+  }
+
+  RenderFrame* frame = beginRenderFrame(header.type == FRAME_TYPE_DELTA ? RENDER_DELTA : RENDER_BITMAP);
+  if (frame == nullptr) {
+    return;
+  }
+
+  if (header.type == FRAME_TYPE_SHOW_CACHED) {
+    if (spriteCacheLoad(header.id, *frame)) {
+      // Acknowledged under this frame's seq, not the one it was cached with
+      frame->seq = header.seq;
+      commitRenderFrame();
+      return;
+    }
+    LOG_INFO("Cache", "Miss for #%u", (unsigned)header.id);
+    sendTextMessage("{\"type\":\"sprite_miss\",\"id\":%u}", header.id);
+    return;
+  }
+
+  if (decodePokemonFrame(payload, length, *frame)) {
+    commitRenderFrame();
+    // Stored after queueing, so the flash write never delays the redraw
+    if (header.type == FRAME_TYPE_BITMAP) {
+      spriteCacheStore(header.id, payload, length);
+    }
+  }
+}
+
 /**
  * WebSocket event handler - called when events occur
+ * Runs on the network task: messages are decoded into render frames and
+ * queued, never drawn here.
  */
 void webSocketEvent(WStype_t type, uint8_t * payload, size_t length) {
+  if (type == WStype_TEXT || type == WStype_BIN) {
+    // Render frames queued while handling this message carry its arrival
+    // time and the trace announced for it
+    messageReceivedAt = micros();
+    messageTraceId = nextTraceId;
+    messageTraceTs = nextTraceTs;
+    nextTraceId = 0;
+  }
+
   switch(type) {
     case WStype_DISCONNECTED:
-      Serial.println("[WebSocket] Disconnected");
-      if (globalDisplay) {
-        globalDisplay->clearDisplay();
-        globalDisplay->setTextSize(1);
-        globalDisplay->setTextColor(SSD1306_WHITE);
-        
-        int x1 = centerText(*globalDisplay, "WebSocket", 0);
-        globalDisplay->setCursor(x1, 20);
-        globalDisplay->println("WebSocket");
-        
-        int x2 = centerText(*globalDisplay, "Disconnected", 0);
-        globalDisplay->setCursor(x2, 35);
-        globalDisplay->println("Disconnected");
-        globalDisplay->display();
-      }
+      LOG_INFO("WebSocket", "Disconnected");
+      webSocketDisconnects++;
+      infoStreamActive = false;
+      queueStatus("WebSocket", "Disconnected");
       break;
     case WStype_CONNECTED:
-      Serial.println("[WebSocket] Connected to server!");
-      // Send identification message to server
-      webSocket.sendTXT("{\"type\":\"identify\",\"client\":\"ESP32\"}");
+      LOG_INFO("WebSocket", "Connected to server!");
+      webSocketConnects++;
+      // Send identification message to server, listing the cached sprites
+      {
+        const size_t cachedSize = SPRITE_CACHE_MAX_ENTRIES * 6;
+        char* cached = (char*)messageArena.alloc(cachedSize);
+        if (cached != nullptr) {
+          spriteCacheListIds(cached, cachedSize);
+        }
+        // After a reconnect, "resume" asks the server for the current screen again
+        sendTextMessage("{\"type\":\"identify\",\"client\":\"ESP32\",\"cached\":[%s],\"trace\":1%s}",
+                        cached != nullptr ? cached : "", webSocketConnects > 1 ? ",\"resume\":1" : "");
+        messageArena.reset();
+      }
+      if (infoSubscribed) {
+        sendTextMessage("{\"type\":\"subscribe\",\"topic\":\"info\"}");
+      }
       break;
     case WStype_TEXT:
       {
-        String message = String((char*)payload);
-        Serial.print("[WebSocket] Received text: ");
-        Serial.println(message);
-        
-        // Display message on OLED
-        if (globalDisplay) {
-          // First, check if this is a Pokemon bitmap message
-          if (parseAndDisplayPokemonBitmap(*globalDisplay, message)) {
-            // Successfully displayed Pokemon bitmap
-            break;
-          }
-          
-          // Check if message contains ASCII art patterns (multiple lines, special chars)
-          // For ASCII art, we preserve line breaks and display as-is
-          bool isAsciiArt = message.indexOf('\n') != -1 || 
-                           message.length() > 50; // Likely ASCII art if long or has newlines
-          
-          if (isAsciiArt) {
-            // Display as ASCII art (preserve line breaks, handle scrolling)
-            displayAsciiArt(*globalDisplay, message);
-          } else {
-            // Display as regular message (centered)
-            globalDisplay->clearDisplay();
-            globalDisplay->setTextSize(1);
-            globalDisplay->setTextColor(SSD1306_WHITE);
-            
-            // Display "Message:" header (centered)
-            int xHeader = centerText(*globalDisplay, "Message:", 0);
-            globalDisplay->setCursor(xHeader, 5);
-            globalDisplay->println("Message:");
-            
-            // Display the message, wrapping if necessary (centered)
-            int lineHeight = 8;
-            int maxWidth = 128;
-            int maxLines = 6; // Leave some space
-            int yPos = 18;
-            int charWidth = 6; // Approximate character width for text size 1
-            
-            // Split message into lines that fit the display width
-            int startPos = 0;
-            int lineCount = 0;
-            
-            while (startPos < message.length() && lineCount < maxLines) {
-              int charsPerLine = maxWidth / charWidth;
-              int endPos = startPos + charsPerLine;
-              
-              // If message is longer than one line, try to break at a space
-              if (endPos < message.length()) {
-                int lastSpace = message.lastIndexOf(' ', endPos);
-                if (lastSpace > startPos) {
-                  endPos = lastSpace;
-                }
-              }
-              
-              String line = message.substring(startPos, endPos);
-              int xLine = centerText(*globalDisplay, line, 0);
-              globalDisplay->setCursor(xLine, yPos);
-              globalDisplay->println(line);
-              
-              yPos += lineHeight;
-              lineCount++;
-              startPos = endPos;
-              
-              // Skip space if we broke at a space
-              if (startPos < message.length() && message.charAt(startPos) == ' ') {
-                startPos++;
-              }
-            }
-            
-            // If message was truncated, show "..." (centered)
-            if (startPos < message.length()) {
-              int xDots = centerText(*globalDisplay, "...", 0);
-              globalDisplay->setCursor(xDots, yPos);
-              globalDisplay->println("...");
-            }
-            
-            globalDisplay->display();
-          }
+        // Trace announcements only tag the next message
+        if (applyTraceMessage((const char*)payload, length)) {
+          break;
+        }
+
+        // Only the start of the payload: a sprite message is kilobytes
+        LOG_INFO("WebSocket", "Received text, %u bytes: %.*s%s", (unsigned)length,
+                 logPreviewLength(length), (const char*)payload, length > LOG_PREVIEW_LENGTH ? "..." : "");
+
+        // System info snapshots and deltas only patch the info lines
+        if (applyInfoMessage((const char*)payload, length)) {
+          break;
+        }
+
+        // Check if this is a Pokemon bitmap message
+        RenderFrame* frame = beginRenderFrame(RENDER_BITMAP);
+        if (frame == nullptr) {
+          break;
         }
+        if (parsePokemonBitmapJson((const char*)payload, length, *frame)) {
+          commitRenderFrame();
+          break;
+        }
+
+        // Check if message contains ASCII art patterns (multiple lines, special chars)
+        // For ASCII art, we preserve line breaks and display as-is
+        bool isAsciiArt = memchr(payload, '\n', length) != nullptr ||
+                          length > 50; // Likely ASCII art if long or has newlines
+        queueText(isAsciiArt ? RENDER_ASCII_ART : RENDER_TEXT, (const char*)payload, length);
       }
       break;
     case WStype_BIN:
-      Serial.print("[WebSocket] Received binary data, length: ");
-      Serial.println(length);
+      LOG_INFO("WebSocket", "Received binary frame, length: %u", (unsigned)length);
+      handleBinaryFrame(payload, length);
       break;
     case WStype_ERROR:
-      Serial.println("[WebSocket] Error occurred");
+      LOG_WARN("WebSocket", "Error occurred");
       break;
     default:
       break;
   }
+
+  // Everything allocated while handling this message is released at once
+  messageArena.reset();
+  messageReceivedAt = 0;
+  messageTraceId = 0;
 }
 
 /**
- * Connects to WebSocket server and logs connection status
- * @param display Reference to the Adafruit_SSD1306 display object
- * @return true if connection successful, false otherwise
+ * Starts the WebSocket handshake without waiting for it to complete
+ * The handshake progresses on every webSocket.loop() call. Called again
+ * for every attempt, which makes exactly one connect: the library's
+ * reconnect interval is the whole attempt window, so it never retries on
+ * its own, and the caller schedules the next attempt.
+ * @param attemptWindow Time the attempt gets before it is given up (ms)
  */
-bool connectWebSocket(Adafruit_SSD1306& display) {
-  // Check WiFi connection first
-  if (!checkWiFiConnection(display)) {
-    Serial.println("[WebSocket] WiFi not connected");
+void beginWebSocket(unsigned long attemptWindow) {
+  // Initialize WebSocket client
+  webSocket.begin(WEBSOCKET_HOST, WEBSOCKET_PORT, WEBSOCKET_PATH);
+  webSocket.onEvent(webSocketEvent);
+  webSocket.setReconnectInterval(attemptWindow);
+  webSocket.armConnect();
+  // A half-open socket (AP gone, server gone) is noticed within ~21 s
+  webSocket.enableHeartbeat(WEBSOCKET_HEARTBEAT_INTERVAL, WEBSOCKET_PONG_TIMEOUT, WEBSOCKET_MISSED_PONGS);
+}
+
+/**
+ * Subscribes to the server's system info stream
+ * The server answers with a full snapshot, then pushes only changed fields.
+ * The subscription is renewed automatically after a reconnect.
+ * @return true if the request was sent
+ */
+bool subscribeSystemInfo() {
+  infoSubscribed = true;
+  if (!webSocket.isConnected()) {
     return false;
   }
+  bool sent = sendTextMessage("{\"type\":\"subscribe\",\"topic\":\"info\"}");
+  messageArena.reset();
+  return sent;
+}
 
-  // Store display reference for use in event handler
-  globalDisplay = &display;
-
+/**
+ * Shows the WebSocket connection status screen
+ * @param display Reference to the NamiDisplay object
+ * @param status Second line of the screen (e.g. "Connected!")
+ */
+void showWebSocketStatus(NamiDisplay& display, const char* status) {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
   
-  int x1 = centerText(display, "Connecting", 0);
+  int x1 = centerText("WebSocket");
   display.setCursor(x1, 20);
-  display.println("Connecting");
+  display.println("WebSocket");
   
-  int x2 = centerText(display, "WebSocket...", 0);
+  int x2 = centerText(status);
   display.setCursor(x2, 35);
-  display.println("WebSocket...");
+  display.println(status);
   display.display();
+}
 
-  // Initialize WebSocket client
-  webSocket.begin(WEBSOCKET_HOST, WEBSOCKET_PORT, WEBSOCKET_PATH);
-  webSocket.onEvent(webSocketEvent);
-  webSocket.setReconnectInterval(5000);
-
-  // Try to connect (with timeout)
-  unsigned long startTime = millis();
-  const unsigned long timeout = 10000; // 10 seconds timeout
-
-  while (!webSocket.isConnected() && (millis() - startTime < timeout)) {
-    webSocket.loop();
-    delay(100);
+/**
+ * Starts an asynchronous /info request and returns immediately
+ * The response is picked up by pollSystemInfo().
+ * @return true if the request was started
+ */
+bool requestSystemInfo() {
+  // Check WiFi connection first
+  if (!checkWiFiConnection()) {
+    LOG_INFO("Info", "WiFi not connected");
+    return false;
   }
 
-  if (webSocket.isConnected()) {
-    Serial.println("[WebSocket] Connection succeeded!");
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    int x1 = centerText(display, "WebSocket", 0);
-    display.setCursor(x1, 20);
-    display.println("WebSocket");
-    
-    int x2 = centerText(display, "Connected!", 0);
-    display.setCursor(x2, 35);
-    display.println("Connected!");
-    display.display();
-    delay(2000);
-    return true;
-  } else {
-    Serial.println("[WebSocket] Connection failed!");
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    int x1 = centerText(display, "WebSocket", 0);
-    display.setCursor(x1, 20);
-    display.println("WebSocket");
-    
-    int x2 = centerText(display, "Failed!", 0);
-    display.setCursor(x2, 35);
-    display.println("Failed!");
-    display.display();
-    delay(2000);
+  // The network loop sleeps until the response is in
+  infoRequest.onFinished(wakeNetworkTask);
+  if (!infoRequest.get(WEBSOCKET_HOST, WEBSOCKET_PORT, INFO_PATH, INFO_TIMEOUT)) {
+    LOG_INFO("Info", "Previous request still running");
     return false;
   }
+
+  queueStatus("Fetching", "system info...");
+  return true;
 }
 
 /**
- * Fetches system info from /info endpoint and displays key information
- * @param display Reference to the Adafruit_SSD1306 display object
+ * Decodes an /info?profile=nami response and queues the info screen
+ * Runs on the network task and never touches the display.
+ * @param data Response body
+ * @param length Length of the body in bytes
  * @return true if successful, false otherwise
  */
-bool fetchAndDisplaySystemInfo(Adafruit_SSD1306& display) {
-  // Check WiFi connection first
-  if (!checkWiFiConnection(display)) {
-    Serial.println("[Info] WiFi not connected");
+bool queueSystemInfo(const uint8_t* data, size_t length) {
+  if (!decodeInfoProfile(data, length, systemInfo)) {
+    LOG_WARN("Info", "Bad info profile, length: %u", (unsigned)length);
+    queueStatus("Parse Error", "Bad info profile");
     return false;
   }
 
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-  
-  int x1 = centerText(display, "Fetching", 0);
-  display.setCursor(x1, 20);
-  display.println("Fetching");
-  
-  int x2 = centerText(display, "system info...", 0);
-  display.setCursor(x2, 35);
-  display.println("system info...");
-  display.display();
+  publishSystemInfo(true);
 
-  HTTPClient http;
-  String response = "";
-
-  // Begin HTTP request
-  http.begin(INFO_ENDPOINT);
-  http.setTimeout(10000); // 10 second timeout
-
-  // Make GET request
-  int httpCode = http.GET();
-
-  if (httpCode == HTTP_CODE_OK) {
-    // Success - read the response
-    response = http.getString();
-    Serial.println("[Info] Response received:");
-    Serial.println(response);
-  } else {
-    Serial.print("[Info] HTTP error code: ");
-    Serial.println(httpCode);
-    http.end();
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    int x1 = centerText(display, "HTTP Error", 0);
-    display.setCursor(x1, 15);
-    display.println("HTTP Error");
-    
-    String codeStr = "Code: " + String(httpCode);
-    int x2 = centerText(display, codeStr, 0);
-    display.setCursor(x2, 30);
-    display.print("Code: ");
-    display.println(httpCode);
-    display.display();
-    delay(3000);
+  LOG_DEBUG("Info", "%s (%s), up %ld min, %ld cores @ %ld MHz, %ld/%ld MB used",
+            systemInfo.hostname, systemInfo.platform, systemInfo.uptime, systemInfo.cores,
+            systemInfo.speed, systemInfo.ramUsed, systemInfo.ramTotal);
+  return true;
+}
+
+/**
+ * Completes the in-flight /info request, if it has finished
+ * Call from the network task loop.
+ * @return true if a response was received and queued
+ */
+bool pollSystemInfo() {
+  if (!infoRequest.poll()) {
     return false;
   }
 
-  http.end();
-
-  // Parse JSON response
-  StaticJsonDocument<4096> doc;
-  DeserializationError error = deserializeJson(doc, response);
-
-  if (error) {
-    Serial.print("[Info] JSON parse error: ");
-    Serial.println(error.c_str());
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    int x1 = centerText(display, "Parse Error", 0);
-    display.setCursor(x1, 20);
-    display.println("Parse Error");
-    
-    String errorStr = String(error.c_str());
-    int x2 = centerText(display, errorStr, 0);
-    display.setCursor(x2, 35);
-    display.println(error.c_str());
-    display.display();
-    delay(3000);
+  int httpCode = infoRequest.status();
+  if (httpCode != 200) {
+    LOG_WARN("Info", "HTTP error code: %d", httpCode);
+
+    char codeStr[16];
+    snprintf(codeStr, sizeof(codeStr), "Code: %d", httpCode);
+    queueStatus("HTTP Error", codeStr);
     return false;
   }
 
-  // Extract and display key information
-  display.clearDisplay();
-  display.setTextSize(1);
-  display.setTextColor(SSD1306_WHITE);
-
-  int lineHeight = 8; // Text size 1 uses ~8 pixels per line
-  int yPos = 0;
+  LOG_INFO("Info", "Response received in %lu ms", (unsigned long)infoRequest.elapsed());
 
-  // System info - Hostname with bitmap
-  if (doc.containsKey("system")) {
-    JsonObject system = doc["system"];
-    display.setCursor(0, yPos);
-    String hostname = system["hostname"] | "Unknown";
-    if (hostname.length() > 16) {
-      hostname = hostname.substring(0, 16);
-    }
-    // Display hostname text
-    display.print(hostname);
-    yPos += lineHeight;
-    
-    // Platform
-    display.setCursor(0, yPos);
-    String platform = system["platform"] | "Unknown";
-    if (platform.length() > 16) {
-      platform = platform.substring(0, 16);
-    }
-    display.println(platform);
-    yPos += lineHeight;
-  }
+  return queueSystemInfo((const uint8_t*)infoRequest.body(), infoRequest.length());
+}
 
-  // CPU info
-  if (doc.containsKey("cpu")) {
-    JsonObject cpu = doc["cpu"];
-    display.setCursor(0, yPos);
-    int cores = cpu["cores"] | 0;
-    float speed = cpu["speed"] | 0.0;
-    display.print("CPU: ");
-    display.print(cores);
-    display.print("C @ ");
-    display.print((int)speed);
-    display.print("MHz");
-    yPos += lineHeight;
+/**
+ * Tells the server which frame the render task last put on screen, and
+ * asks for a full frame when a delta could not be applied
+ * (see frame_protocol.h). Only sends when something changed.
+ */
+void sendFrameAcks() {
+  uint16_t presented = presentedSeq.load(std::memory_order_acquire);
+  if (presented != ackedSeq &&
+      sendTextMessage("{\"type\":\"frame_ack\",\"seq\":%u}", presented)) {
+    ackedSeq = presented;
   }
+  // Every message gets its own arena buffer, sized for the largest one
+  messageArena.reset();
 
-  // Memory info
-  if (doc.containsKey("memory")) {
-    JsonObject memory = doc["memory"];
-    display.setCursor(0, yPos);
-    float totalMB = (memory["total"] | 0) / (1024.0 * 1024.0);
-    float usedMB = (memory["used"] | 0) / (1024.0 * 1024.0);
-    display.print("RAM: ");
-    display.print((int)usedMB);
-    display.print("/");
-    display.print((int)totalMB);
-    display.print("MB");
-    yPos += lineHeight;
+  uint16_t rejected = rejectedSeq.load(std::memory_order_acquire);
+  if (rejected != 0 && rejected != resyncSeq &&
+      sendTextMessage("{\"type\":\"frame_resync\",\"seq\":%u}", rejected)) {
+    resyncSeq = rejected;
   }
-
-  // Uptime info
-  if (doc.containsKey("system") && yPos < 56) {
-    JsonObject system = doc["system"];
-    display.setCursor(0, yPos);
-    unsigned long uptime = system["uptime"] | 0;
-    unsigned long hours = uptime / 3600;
-    unsigned long minutes = (uptime % 3600) / 60;
-    display.print("Up: ");
-    display.print(hours);
-    display.print("h ");
-    display.print(minutes);
-    display.print("m");
-    yPos += lineHeight;
+  messageArena.reset();
+
+  // Traced messages that reached the screen
+  TraceAck* ack;
+  while ((ack = traceRing.front()) != nullptr) {
+    sendTextMessage("{\"type\":\"trace_ack\",\"id\":%u,\"ts\":%u,\"parse_us\":%u,\"render_us\":%u,\"flush_us\":%u}",
+                    (unsigned)ack->id, (unsigned)ack->ts, (unsigned)ack->parseUs,
+                    (unsigned)ack->renderUs, (unsigned)ack->flushUs);
+    traceRing.pop();
+    messageArena.reset();
   }
+}
 
-  // Network info (first interface) - only if space available
-  if (doc.containsKey("network") && yPos < 56) {
-    JsonObject network = doc["network"];
-    // Try to find en0 (Ethernet) or first available interface
-    if (network.containsKey("en0")) {
-      JsonArray en0 = network["en0"];
-      if (en0.size() > 0) {
-        JsonObject en0Obj = en0[0];
-        if (en0Obj.containsKey("address")) {
-          display.setCursor(0, yPos);
-          String ip = en0Obj["address"].as<String>();
-          if (ip.length() > 16) {
-            ip = ip.substring(0, 16);
-          }
-          display.println(ip);
-        }
-      }
+/**
+ * Copies a log line into a JSON string body, escaping quotes, backslashes
+ * and control characters
+ * @param text Log line
+ * @param out Destination, 2 * LOG_RECORD_SIZE bytes holds any line
+ * @param size Size of out
+ */
+void escapeLogText(const char* text, char* out, size_t size) {
+  size_t n = 0;
+  for (; *text != '\0' && n + 2 < size; text++) {
+    char c = *text;
+    if (c == '"' || c == '\\') {
+      out[n++] = '\\';
+      out[n++] = c;
+    } else {
+      out[n++] = (uint8_t)c < 0x20 ? ' ' : c;
     }
   }
-
-  display.display();
-
-  // Log additional info to Serial
-  Serial.println("[Info] System Information:");
-  if (doc.containsKey("system")) {
-    JsonObject system = doc["system"];
-    Serial.print("  Hostname: ");
-    Serial.println(system["hostname"].as<String>());
-    Serial.print("  Platform: ");
-    Serial.println(system["platform"].as<String>());
-    Serial.print("  Arch: ");
-    Serial.println(system["arch"].as<String>());
-    Serial.print("  Uptime: ");
-    Serial.print(system["uptime"].as<unsigned long>());
-    Serial.println(" seconds");
-  }
-  if (doc.containsKey("cpu")) {
-    JsonObject cpu = doc["cpu"];
-    Serial.print("  CPU Model: ");
-    Serial.println(cpu["model"].as<String>());
-    Serial.print("  Cores: ");
-    Serial.println(cpu["cores"].as<int>());
-    Serial.print("  Speed: ");
-    Serial.print(cpu["speed"].as<float>());
-    Serial.println(" MHz");
-  }
-  if (doc.containsKey("memory")) {
-    JsonObject memory = doc["memory"];
-    Serial.print("  Memory Total: ");
-    Serial.print((memory["total"].as<unsigned long>() / (1024 * 1024)));
-    Serial.println(" MB");
-    Serial.print("  Memory Used: ");
-    Serial.print((memory["used"].as<unsigned long>() / (1024 * 1024)));
-    Serial.println(" MB");
-    Serial.print("  Memory Free: ");
-    Serial.print((memory["free"].as<unsigned long>() / (1024 * 1024)));
-    Serial.println(" MB");
-  }
-
-  return true;
+  out[n] = '\0';
 }
 
 /**
- * Maintains WebSocket connection (call this in loop)
+ * Forwards queued warnings and errors (see log.h) to the server
+ * At most LOG_REMOTE_DEPTH per call: a failed send logs an error itself,
+ * which must not keep this loop going.
  */
-void maintainWebSocket() {
-  if (webSocket.isConnected()) {
-    webSocket.loop();
+void sendRemoteLogs() {
+  LogRecord record;
+  char text[2 * LOG_RECORD_SIZE];
+  for (int i = 0; i < LOG_REMOTE_DEPTH && remoteLogRing.pop(record); i++) {
+    escapeLogText(record.text, text, sizeof(text));
+    sendTextMessage("{\"type\":\"log\",\"level\":\"%s\",\"ms\":%lu,\"text\":\"%s\"}",
+                    logLevelNames[record.level], (unsigned long)record.ms, text);
+    messageArena.reset();
   }
 }
 
@@ -2,225 +2,259 @@
 #define WIFI_CONNECTION_H
 
 #include <WiFi.h>
-#include <Adafruit_SSD1306.h>
+#include <Preferences.h>
+#include "nami_display.h"
 #include <Adafruit_GFX.h>
 #include "secrets.h"
+#include "render_queue.h"
+#include "text_layout.h"
+#include "log.h"
 
 #define SCREEN_WIDTH 128
 #define SCREEN_HEIGHT 64
 
 /**
- * Helper function to center text on the display
- * @param display Reference to the Adafruit_SSD1306 display object
- * @param text The text string to center
- * @param y The y-coordinate for the text
- * @return The x-coordinate where the text should start
+ * Fast connect
+ *
+ * The AP (BSSID and channel) and DHCP lease of the last successful
+ * connection are kept in NVS ("nami" namespace, "wifiCache" key). The next
+ * attempt joins that AP directly, which skips the scan of every channel,
+ * and only falls back to a normal scanning connect when it does not come
+ * up within WIFI_FAST_CONNECT_TIMEOUT. The cache is rewritten only when it
+ * changed.
+ *
+ * Reusing the lease as a static configuration also skips DHCP. It is off
+ * by default, since the router may have given the address away in the
+ * meantime: enable it with -DNAMI_WIFI_REUSE_LEASE=1, or the "reuseLease"
+ * bool key in the "nami" NVS namespace (which takes precedence).
+ *
+ * Connecting never blocks: start with beginWiFi(), then poll serviceWiFi().
+ * Retries after a failed attempt are scheduled by the connection
+ * supervisor (connection_supervisor.h).
  */
-inline int centerText(Adafruit_SSD1306& display, const char* text, int y) {
-  display.setTextSize(1);
-  int16_t x1, y1;
-  uint16_t w, h;
-  display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
-  return (SCREEN_WIDTH - w) / 2;
+
+#ifndef NAMI_WIFI_REUSE_LEASE
+#define NAMI_WIFI_REUSE_LEASE 0
+#endif
+
+#define WIFI_FAST_CONNECT_TIMEOUT 1500  // Cached AP attempt before scanning (ms)
+#define WIFI_SCAN_CONNECT_TIMEOUT 10000 // Scanning attempt before giving up (ms)
+#define WIFI_CACHE_VERSION 1
+
+struct WiFiCache {
+  uint8_t version;
+  uint8_t bssid[6];
+  uint8_t channel;
+  uint32_t ip;
+  uint32_t gateway;
+  uint32_t subnet;
+  uint32_t dns;
+};
+
+struct WiFiLink {
+  WiFiCache cache;
+  bool cacheValid;
+  bool reuseLease;
+  bool leaseApplied;   // Static config set from the cache, DHCP skipped
+  bool connecting;     // An attempt is in progress
+  bool fastPath;       // The attempt targets the cached AP
+  unsigned long attemptStart;
+};
+
+WiFiLink wifiLink;
+
+/**
+ * Loads the cached AP and lease, and the lease reuse setting, from NVS
+ */
+void loadWiFiCache() {
+  WiFiLink& link = wifiLink;
+  Preferences prefs;
+  link.cacheValid = false;
+  link.reuseLease = NAMI_WIFI_REUSE_LEASE;
+  // Read-only open fails when the namespace has never been written
+  if (prefs.begin("nami", true)) {
+    link.reuseLease = prefs.getBool("reuseLease", link.reuseLease);
+    link.cacheValid = prefs.getBytes("wifiCache", &link.cache, sizeof(link.cache)) == sizeof(link.cache) &&
+                      link.cache.version == WIFI_CACHE_VERSION && link.cache.channel != 0;
+    prefs.end();
+  }
+}
+
+/**
+ * Stores the AP and lease of the current connection, if they changed
+ */
+void saveWiFiCache() {
+  WiFiLink& link = wifiLink;
+  WiFiCache current;
+  memset(&current, 0, sizeof(current));
+  current.version = WIFI_CACHE_VERSION;
+  memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+  current.channel = WiFi.channel();
+  current.ip = WiFi.localIP();
+  current.gateway = WiFi.gatewayIP();
+  current.subnet = WiFi.subnetMask();
+  current.dns = WiFi.dnsIP();
+
+  if (link.cacheValid && memcmp(&current, &link.cache, sizeof(current)) == 0) {
+    return;
+  }
+  Preferences prefs;
+  if (prefs.begin("nami", false)) {
+    prefs.putBytes("wifiCache", &current, sizeof(current));
+    prefs.end();
+    link.cache = current;
+    link.cacheValid = true;
+    LOG_INFO("WiFi", "Cached AP and lease updated");
+  }
 }
 
 /**
- * Helper function to center text on the display (String version)
- * @param display Reference to the Adafruit_SSD1306 display object
+ * Starts one connection attempt
+ * @param fast Join the cached AP directly (ignored without a cache)
+ */
+void startWiFiAttempt(bool fast) {
+  WiFiLink& link = wifiLink;
+  link.fastPath = fast && link.cacheValid;
+  link.connecting = true;
+  link.attemptStart = millis();
+
+  const WiFiCache& cache = link.cache;
+  if (link.fastPath && link.reuseLease) {
+    WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway), IPAddress(cache.subnet), IPAddress(cache.dns));
+    link.leaseApplied = true;
+  } else if (link.leaseApplied) {
+    // Back to DHCP
+    WiFi.config(IPAddress(), IPAddress(), IPAddress());
+    link.leaseApplied = false;
+  }
+
+  if (link.fastPath) {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD, cache.channel, cache.bssid);
+  } else {
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+  }
+}
+
+/**
+ * Helper function to center text on the display, at text size 1
  * @param text The text string to center
- * @param y The y-coordinate for the text
  * @return The x-coordinate where the text should start
  */
-inline int centerText(Adafruit_SSD1306& display, const String& text, int y) {
-  return centerText(display, text.c_str(), y);
+inline int centerText(const char* text) {
+  return textCenterX(strlen(text));
 }
 
 /**
- * Attempts to connect to WiFi and displays connection status on the OLED display
- * @param display Reference to the Adafruit_SSD1306 display object
- * @param maxAttempts Maximum number of connection attempts (default: 20)
- * @param attemptDelay Delay between attempts in milliseconds (default: 500)
- * @return true if connection successful, false otherwise
+ * Starts associating with the configured WiFi network without waiting
+ * Progress is polled with serviceWiFi()
  */
-bool connectToWiFi(Adafruit_SSD1306& display, int maxAttempts = 20, int attemptDelay = 500) {
+void beginWiFi() {
+  // The library would otherwise rewrite the credentials to flash on every begin()
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  loadWiFiCache();
+  startWiFiAttempt(true);
+}
+
+/**
+ * Ends the attempt in progress as connected: logs how long it took and
+ * caches the AP for the next fast connect
+ */
+void finishWiFiAttempt() {
+  WiFiLink& link = wifiLink;
+  if (link.connecting) {
+    link.connecting = false;
+    LOG_INFO("WiFi", "Connected in %lu ms (%s)", (unsigned long)(millis() - link.attemptStart),
+             link.fastPath ? "cached AP" : "scan");
+    saveWiFiCache();
+  }
+}
+
+/**
+ * Advances the connection attempt in progress, if any
+ * Falls back from the cached AP to a scanning connect, and ends the
+ * attempt (wifiLink.connecting goes false) after WIFI_SCAN_CONNECT_TIMEOUT
+ * without a connection.
+ * @return true if connected
+ */
+bool serviceWiFi() {
+  WiFiLink& link = wifiLink;
+  wl_status_t status = WiFi.status();
+  if (status == WL_CONNECTED) {
+    finishWiFiAttempt();
+    return true;
+  }
+  if (!link.connecting) {
+    return false;
+  }
+
+  unsigned long elapsed = millis() - link.attemptStart;
+  if (link.fastPath &&
+      (elapsed >= WIFI_FAST_CONNECT_TIMEOUT || status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED)) {
+    LOG_INFO("WiFi", "Cached AP not reachable, scanning");
+    startWiFiAttempt(false);
+  } else if (!link.fastPath && elapsed >= WIFI_SCAN_CONNECT_TIMEOUT) {
+    LOG_WARN("WiFi", "Connection attempt failed");
+    link.connecting = false;
+  }
+  return false;
+}
+
+/**
+ * Shows the "WiFi Connected!" screen with the local IP address
+ * @param display Reference to the NamiDisplay object
+ */
+void showWiFiConnected(NamiDisplay& display) {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
-  
-  // Center "Connecting to WiFi..."
-  int x1 = centerText(display, "Connecting to", 0);
+
+  // Center success messages
+  int x1 = centerText("WiFi Connected!");
   display.setCursor(x1, 10);
-  display.println("Connecting to");
+  display.println("WiFi Connected!");
   
-  int x2 = centerText(display, "WiFi...", 0);
-  display.setCursor(x2, 20);
-  display.println("WiFi...");
+  int x2 = centerText("IP Address:");
+  display.setCursor(x2, 25);
+  display.println("IP Address:");
   
-  // Center SSID
-  String ssidStr = String(WIFI_SSID);
-  int x3 = centerText(display, ssidStr, 0);
-  display.setCursor(x3, 35);
-  display.println(WIFI_SSID);
+  IPAddress ip = WiFi.localIP();
+  char ipStr[16];
+  int n = snprintf(ipStr, sizeof(ipStr), "%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+  drawCenteredLine(display, 40, ipStr, min((size_t)max(n, 0), sizeof(ipStr) - 1));
   display.display();
+}
 
-  // Properly initialize WiFi with delays to avoid first-boot failures
-  WiFi.disconnect(true);  // Disconnect any previous connection
-  delay(200);
-  WiFi.mode(WIFI_STA);
-  delay(200);
-  
-  // Start WiFi connection
-  WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-  
-  // Wait for WiFi hardware to initialize - ESP32 needs significant time on first boot
-  // The WiFi stack needs time to power up, scan for networks, and begin connection
-  unsigned long initStartTime = millis();
-  const unsigned long initTimeout = 4000; // Wait up to 4 seconds for initialization
-  int lastStatus = WiFi.status();
-  
-  // Wait until WiFi status indicates it's actively trying to connect
-  // or has already connected, or timeout is reached
-  while ((millis() - initStartTime < initTimeout)) {
-    int currentStatus = WiFi.status();
-    
-    // If already connected, we can proceed immediately
-    if (currentStatus == WL_CONNECTED) {
-      break;
-    }
-    
-    // If status changed from disconnected state, WiFi hardware is initializing
-    if (currentStatus != lastStatus && 
-        (lastStatus == WL_DISCONNECTED || lastStatus == WL_NO_SSID_AVAIL)) {
-      // Status changed, WiFi hardware is initializing - wait a bit more
-      delay(500);
-      break;
-    }
-    
-    delay(100);
-    lastStatus = currentStatus;
-  }
-  
-  // Additional delay to ensure WiFi stack is fully ready
-  // This is critical for first boot success
-  delay(1500);
-
-  int attempts = 0;
-  while (WiFi.status() != WL_CONNECTED && attempts < maxAttempts) {
-    delay(attemptDelay);
-    attempts++;
-
-    // Update display with connection progress (centered)
-    display.fillRect(0, 50, 128, 10, SSD1306_BLACK);
-    String attemptStr = "Attempt " + String(attempts) + "/" + String(maxAttempts);
-    int x4 = centerText(display, attemptStr, 0);
-    display.setCursor(x4, 50);
-    display.print("Attempt ");
-    display.print(attempts);
-    display.print("/");
-    display.print(maxAttempts);
-    display.display();
-  }
-
+/**
+ * Shows the WiFi failure screen displayed before restarting
+ * @param display Reference to the NamiDisplay object
+ */
+void showWiFiFailed(NamiDisplay& display) {
   display.clearDisplay();
   display.setTextSize(1);
   display.setTextColor(SSD1306_WHITE);
-
-  if (WiFi.status() == WL_CONNECTED) {
-    // Center success messages
-    int x5 = centerText(display, "WiFi Connected!", 0);
-    display.setCursor(x5, 10);
-    display.println("WiFi Connected!");
-    
-    int x6 = centerText(display, "IP Address:", 0);
-    display.setCursor(x6, 25);
-    display.println("IP Address:");
-    
-    String ipStr = WiFi.localIP().toString();
-    int x7 = centerText(display, ipStr, 0);
-    display.setCursor(x7, 40);
-    display.println(ipStr);
-    display.display();
-    delay(2000); // Show success message for 2 seconds
-    return true;
-  } else {
-    // Center failure messages
-    int x8 = centerText(display, "Connection", 0);
-    display.setCursor(x8, 10);
-    display.println("Connection");
-    
-    int x9 = centerText(display, "Failed!", 0);
-    display.setCursor(x9, 25);
-    display.println("Failed!");
-    
-    int x10 = centerText(display, "Retrying...", 0);
-    display.setCursor(x10, 40);
-    display.println("Retrying...");
-    display.display();
-    delay(2000); // Show failure message for 2 seconds
-    return false;
-  }
+  
+  int x1 = centerText("WiFi Failed");
+  display.setCursor(x1, 10);
+  display.println("WiFi Failed");
+  
+  int x2 = centerText("Check config");
+  display.setCursor(x2, 25);
+  display.println("Check config");
+  
+  int x3 = centerText("Restarting...");
+  display.setCursor(x3, 40);
+  display.println("Restarting...");
+  display.display();
 }
 
 /**
- * Checks if WiFi is still connected and attempts to reconnect if needed
- * @param display Reference to the Adafruit_SSD1306 display object
+ * Checks if WiFi is connected
+ * Reconnecting is left to the connection supervisor.
  * @return true if connected, false if disconnected
  */
-bool checkWiFiConnection(Adafruit_SSD1306& display) {
-  if (WiFi.status() != WL_CONNECTED) {
-    display.clearDisplay();
-    display.setTextSize(1);
-    display.setTextColor(SSD1306_WHITE);
-    
-    // Center reconnection messages
-    int x1 = centerText(display, "WiFi", 0);
-    display.setCursor(x1, 10);
-    display.println("WiFi");
-    
-    int x2 = centerText(display, "Disconnected", 0);
-    display.setCursor(x2, 25);
-    display.println("Disconnected");
-    
-    int x3 = centerText(display, "Reconnecting...", 0);
-    display.setCursor(x3, 40);
-    display.println("Reconnecting...");
-    display.display();
-    
-    // Properly reinitialize WiFi
-    WiFi.disconnect(true);
-    delay(200);
-    WiFi.mode(WIFI_STA);
-    delay(200);
-    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
-    
-    // Wait for WiFi hardware to initialize
-    unsigned long initStartTime = millis();
-    const unsigned long initTimeout = 2000; // Wait up to 2 seconds for reconnection
-    int lastStatus = WiFi.status();
-    
-    while ((millis() - initStartTime < initTimeout)) {
-      int currentStatus = WiFi.status();
-      
-      // If already connected, we can proceed immediately
-      if (currentStatus == WL_CONNECTED) {
-        break;
-      }
-      
-      // If status changed from disconnected state, WiFi hardware is initializing
-      if (currentStatus != lastStatus && 
-          (lastStatus == WL_DISCONNECTED || lastStatus == WL_NO_SSID_AVAIL)) {
-        delay(500);
-        break;
-      }
-      
-      delay(100);
-      lastStatus = currentStatus;
-    }
-    
-    delay(1000);
-    return false;
-  }
-  return true;
+bool checkWiFiConnection() {
+  return WiFi.status() == WL_CONNECTED;
 }
 
 #endif // WIFI_CONNECTION_H
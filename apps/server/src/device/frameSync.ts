@@ -0,0 +1,79 @@
+import { WebSocket } from "ws";
+import { PokemonBitmap } from "../pokemon/pokemon.js";
+
+/**
+ * Frame sequence numbers and acknowledgements per ESP32
+ *
+ * Every sprite frame sent to a device gets a sequence number. The device
+ * answers {"type":"frame_ack","seq":N} once frame N is on screen, or seq 0
+ * when something else replaced it. The last acknowledged bitmap is the base
+ * a delta frame can be encoded against.
+ */
+
+// Frames sent but not acknowledged yet, per device
+const MAX_PENDING_FRAMES = 8;
+
+interface FrameState {
+  nextSeq: number;
+  pending: Map<number, PokemonBitmap>;
+  base: { seq: number; bitmap: PokemonBitmap } | null;
+}
+
+const frameStates = new Map<WebSocket, FrameState>();
+
+const getFrameState = (ws: WebSocket): FrameState => {
+  let state = frameStates.get(ws);
+  if (!state) {
+    // Random start, so an ack for a frame sent over a previous connection
+    // is very unlikely to match a frame of this one
+    state = {
+      nextSeq: 1 + Math.floor(Math.random() * 0xfffe),
+      pending: new Map(),
+      base: null,
+    };
+    frameStates.set(ws, state);
+  }
+  return state;
+};
+
+// Allocate the seq of the next frame, remembering the bitmap it shows
+export const nextFrameSeq = (ws: WebSocket, bitmap: PokemonBitmap): number => {
+  const state = getFrameState(ws);
+  const seq = state.nextSeq;
+  // 16 bit on the wire, 0 means "not tracked"
+  state.nextSeq = seq === 0xffff ? 1 : seq + 1;
+
+  state.pending.set(seq, bitmap);
+  if (state.pending.size > MAX_PENDING_FRAMES) {
+    const oldest = state.pending.keys().next().value;
+    if (oldest !== undefined) {
+      state.pending.delete(oldest);
+    }
+  }
+  return seq;
+};
+
+// Bitmap the device last confirmed on screen, if any
+export const getAckedFrame = (
+  ws: WebSocket
+): { seq: number; bitmap: PokemonBitmap } | null =>
+  frameStates.get(ws)?.base ?? null;
+
+// Bitmap sent as frame seq, if it is still remembered
+export const getSentFrame = (
+  ws: WebSocket,
+  seq: number
+): PokemonBitmap | undefined => frameStates.get(ws)?.pending.get(seq);
+
+export const handleFrameAck = (ws: WebSocket, seq: unknown) => {
+  if (!Number.isInteger(seq)) {
+    return;
+  }
+  const state = getFrameState(ws);
+  const bitmap = state.pending.get(seq as number);
+  state.base = bitmap ? { seq: seq as number, bitmap } : null;
+};
+
+export const forgetFrameState = (ws: WebSocket) => {
+  frameStates.delete(ws);
+};
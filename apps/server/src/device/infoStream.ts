@@ -0,0 +1,147 @@
+import os from "os";
+import { WebSocket } from "ws";
+
+/**
+ * System info stream for ESP32 clients
+ *
+ * A device subscribes with {"type":"subscribe","topic":"info"}. It gets one
+ * snapshot of the fields it displays (marked "full"), then only the fields
+ * whose displayed value changed, checked every INFO_PUSH_INTERVAL_MS.
+ * Values are pre-scaled to what the device shows (MB, MHz, minutes). Used
+ * RAM moves by a few MB on every check even on an idle Pi, so it is only
+ * resent once it is RAM_USED_STEP_MB away from the value the device shows.
+ * An idle Pi then produces about one tiny update a minute, for the uptime.
+ */
+
+const INFO_PUSH_INTERVAL_MS = 5000;
+const RAM_USED_STEP_MB = 8;
+const BYTES_PER_MB = 1024 * 1024;
+
+export interface DeviceInfo {
+  host: string;
+  os: string;
+  cores: number;
+  mhz: number;
+  ramUsed: number;
+  ramTotal: number;
+  upMin: number;
+  ip: string;
+}
+
+// First external IPv4 address (eth0/wlan0 on the Pi, en0 on a Mac)
+const getPrimaryAddress = (): string => {
+  const interfaces = os.networkInterfaces();
+  for (const addresses of Object.values(interfaces)) {
+    for (const address of addresses ?? []) {
+      if (address.family === "IPv4" && !address.internal) {
+        return address.address;
+      }
+    }
+  }
+  return "";
+};
+
+// Fields shown on the device's system info screen
+export const getDeviceInfo = (): DeviceInfo => {
+  const cpus = os.cpus();
+  const total = os.totalmem();
+  return {
+    host: os.hostname(),
+    os: os.platform(),
+    cores: cpus.length,
+    mhz: cpus[0]?.speed || 0,
+    ramUsed: Math.floor((total - os.freemem()) / BYTES_PER_MB),
+    ramTotal: Math.floor(total / BYTES_PER_MB),
+    upMin: Math.floor(os.uptime() / 60),
+    ip: getPrimaryAddress(),
+  };
+};
+
+// Fields of next that differ from previous (ramUsed only past RAM_USED_STEP_MB)
+export const diffDeviceInfo = (
+  previous: DeviceInfo,
+  next: DeviceInfo
+): Partial<DeviceInfo> => {
+  const changed: Partial<DeviceInfo> = {};
+  (Object.keys(next) as (keyof DeviceInfo)[]).forEach((key) => {
+    if (key === "ramUsed") {
+      if (Math.abs(next.ramUsed - previous.ramUsed) >= RAM_USED_STEP_MB) {
+        changed.ramUsed = next.ramUsed;
+      }
+    } else if (previous[key] !== next[key]) {
+      (changed as Record<string, unknown>)[key] = next[key];
+    }
+  });
+  return changed;
+};
+
+/**
+ * Fixed binary record returned by /info?profile=nami
+ * (layout documented in apps/device/src/nami/system_info.h)
+ */
+export const INFO_PROFILE_VERSION = 1;
+export const INFO_PROFILE_SIZE = 64;
+const PROFILE_STRING_SIZE = 16;
+
+export const encodeInfoProfile = (info: DeviceInfo): Buffer => {
+  const record = Buffer.alloc(INFO_PROFILE_SIZE);
+  const clamp = (value: number, max: number) =>
+    Math.min(Math.max(Math.floor(value), 0), max);
+
+  record.writeUInt8(INFO_PROFILE_VERSION, 0);
+  record.writeUInt8(clamp(info.cores, 0xff), 1);
+  record.writeUInt16LE(clamp(info.mhz, 0xffff), 2);
+  record.writeUInt32LE(clamp(info.ramUsed, 0xffffffff), 4);
+  record.writeUInt32LE(clamp(info.ramTotal, 0xffffffff), 8);
+  record.writeUInt32LE(clamp(info.upMin, 0xffffffff), 12);
+  // Strings are truncated to 16 bytes and NUL padded by Buffer.alloc
+  record.write(info.host, 16, PROFILE_STRING_SIZE, "ascii");
+  record.write(info.os, 32, PROFILE_STRING_SIZE, "ascii");
+  record.write(info.ip, 48, PROFILE_STRING_SIZE, "ascii");
+
+  return record;
+};
+
+// Last info sent to each subscriber
+const subscribers = new Map<WebSocket, DeviceInfo>();
+let pushTimer: NodeJS.Timeout | null = null;
+
+const pushInfoUpdates = () => {
+  const next = getDeviceInfo();
+  subscribers.forEach((previous, ws) => {
+    if (ws.readyState !== WebSocket.OPEN) {
+      return;
+    }
+    const changed = diffDeviceInfo(previous, next);
+    if (Object.keys(changed).length === 0) {
+      return;
+    }
+    // "type" must come first, the device checks it before anything else
+    ws.send(JSON.stringify({ type: "info", ...changed }));
+    // Only what was sent, so unsent RAM drift keeps adding up
+    subscribers.set(ws, { ...previous, ...changed });
+  });
+};
+
+// Send a snapshot and start pushing changes to this client
+export const subscribeInfo = (ws: WebSocket) => {
+  const info = getDeviceInfo();
+  ws.send(JSON.stringify({ type: "info", full: 1, ...info }));
+  subscribers.set(ws, info);
+
+  if (!pushTimer) {
+    pushTimer = setInterval(pushInfoUpdates, INFO_PUSH_INTERVAL_MS);
+  }
+  console.log("📊 Info subscriber added. Total subscribers:", subscribers.size);
+};
+
+export const unsubscribeInfo = (ws: WebSocket) => {
+  if (!subscribers.delete(ws)) {
+    return;
+  }
+  if (subscribers.size === 0 && pushTimer) {
+    clearInterval(pushTimer);
+    pushTimer = null;
+  }
+  console.log("📊 Info subscriber removed. Total subscribers:", subscribers.size);
+};
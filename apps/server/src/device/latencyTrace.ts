@@ -0,0 +1,141 @@
+import { WebSocket } from "ws";
+
+/**
+ * End-to-end latency tracing per ESP32, from send to pixels on glass
+ *
+ * A device that lists "trace":1 in its identify message gets
+ * {"type":"trace","id":N,"ts":T} right before every display message sent
+ * with sendTraced. Once that message is on screen it answers
+ * {"type":"trace_ack","id":N,"ts":T,"parse_us":..,"render_us":..,"flush_us":..}
+ * with offsets from its arrival on the device. T is this server's clock in
+ * microseconds (31 bits, so the device can echo it as a plain long), which
+ * makes acks self-contained: nothing is remembered per trace.
+ *
+ * From one ack:
+ *   total   send -> ack received (what a web client waits for, plus the ack's trip back)
+ *   network total minus the time on the device (WiFi/TCP both ways)
+ *   parse   arrival -> render frame queued
+ *   render  queued -> drawn (queue wait included)
+ *   flush   drawn -> sent over I2C
+ */
+
+// Acks kept per device for the percentiles
+const TRACE_WINDOW = 256;
+// How often the stats are pushed to web clients at most
+const TRACE_BROADCAST_INTERVAL_MS = 5000;
+const TS_MODULO = 2 ** 31;
+
+const STAGES = ["total", "network", "parse", "render", "flush"] as const;
+type Stage = (typeof STAGES)[number];
+
+type TraceSample = Record<Stage, number>;
+
+export interface StageStats {
+  p50: number;
+  p95: number;
+  p99: number;
+}
+
+export interface DeviceLatency {
+  device: string;
+  samples: number;
+  // Milliseconds
+  stages: Record<Stage, StageStats>;
+}
+
+interface DeviceTrace {
+  device: string;
+  nextId: number;
+  samples: TraceSample[];
+  lastBroadcast: number;
+}
+
+const traces = new Map<WebSocket, DeviceTrace>();
+const clockStart = process.hrtime.bigint();
+
+// Server clock for trace timestamps, wraps every ~35 minutes
+const traceClock = (): number =>
+  Number(((process.hrtime.bigint() - clockStart) / 1000n) % BigInt(TS_MODULO));
+
+// Start tracing a device that announced support in its identify message
+export const startTracing = (ws: WebSocket, device: string, supported: unknown) => {
+  if (supported !== 1) {
+    traces.delete(ws);
+    return;
+  }
+  traces.set(ws, { device, nextId: 1, samples: [], lastBroadcast: 0 });
+};
+
+export const forgetTrace = (ws: WebSocket) => {
+  traces.delete(ws);
+};
+
+// Send a display message, announcing a trace first if the device takes them
+export const sendTraced = (ws: WebSocket, data: string | Buffer, binary = false) => {
+  const trace = traces.get(ws);
+  if (trace) {
+    const id = trace.nextId;
+    trace.nextId = id >= TS_MODULO - 1 ? 1 : id + 1;
+    ws.send(JSON.stringify({ type: "trace", id, ts: traceClock() }));
+  }
+  ws.send(data, { binary });
+};
+
+const microsField = (ack: Record<string, unknown>, key: string): number | null => {
+  const value = ack[key];
+  return Number.isInteger(value) && (value as number) >= 0 ? (value as number) : null;
+};
+
+// Record a trace_ack. Returns true when the stats are due for a push to web clients.
+export const handleTraceAck = (ws: WebSocket, ack: Record<string, unknown>): boolean => {
+  const trace = traces.get(ws);
+  const ts = microsField(ack, "ts");
+  const parseUs = microsField(ack, "parse_us");
+  const renderUs = microsField(ack, "render_us");
+  const flushUs = microsField(ack, "flush_us");
+  if (!trace || ts === null || parseUs === null || renderUs === null || flushUs === null) {
+    return false;
+  }
+
+  const totalUs = (traceClock() - ts + TS_MODULO) % TS_MODULO;
+  trace.samples.push({
+    total: totalUs / 1000,
+    network: Math.max(totalUs - flushUs, 0) / 1000,
+    parse: parseUs / 1000,
+    render: Math.max(renderUs - parseUs, 0) / 1000,
+    flush: Math.max(flushUs - renderUs, 0) / 1000,
+  });
+  if (trace.samples.length > TRACE_WINDOW) {
+    trace.samples.shift();
+  }
+
+  const now = Date.now();
+  if (now - trace.lastBroadcast < TRACE_BROADCAST_INTERVAL_MS) {
+    return false;
+  }
+  trace.lastBroadcast = now;
+  return true;
+};
+
+// Nearest-rank percentile of sorted values
+const percentile = (sorted: number[], p: number): number =>
+  sorted.length === 0
+    ? 0
+    : sorted[Math.min(sorted.length - 1, Math.ceil((p / 100) * sorted.length) - 1)];
+
+const round = (ms: number): number => Math.round(ms * 100) / 100;
+
+// p50/p95/p99 per stage for every traced device
+export const getLatencyStats = (): DeviceLatency[] =>
+  Array.from(traces.values()).map((trace) => {
+    const stages = {} as Record<Stage, StageStats>;
+    STAGES.forEach((stage) => {
+      const sorted = trace.samples.map((sample) => sample[stage]).sort((a, b) => a - b);
+      stages[stage] = {
+        p50: round(percentile(sorted, 50)),
+        p95: round(percentile(sorted, 95)),
+        p99: round(percentile(sorted, 99)),
+      };
+    });
+    return { device: trace.device, samples: trace.samples.length, stages };
+  });
@@ -0,0 +1,338 @@
+/**
+ * Binary frame protocol shared with the ESP32 firmware
+ * (apps/device/src/nami/frame_protocol.h)
+ *
+ * Header layout (12 bytes):
+ *   0  version     (FRAME_VERSION)
+ *   1  type        (FrameType)
+ *   2  flags       (FrameFlag)
+ *   3  nameLength
+ *   4  id          (uint16, little endian)
+ *   6  width       (uint8, pixels)
+ *   7  height      (uint8, pixels)
+ *   8  seq         (uint16, little endian, 0 = not tracked)
+ *   10 baseSeq     (uint16, little endian, FrameType.DELTA only)
+ * followed by the name (ASCII, not null terminated) and the 1bpp payload
+ * (row-major, MSB first), PackBits compressed when FrameFlag.RLE is set.
+ */
+
+export const FRAME_VERSION = 2;
+export const FRAME_HEADER_SIZE = 12;
+const MAX_NAME_LENGTH = 255;
+
+export const FrameType = {
+  BITMAP: 0x01,
+  // Header only: show the sprite with this id from the device's flash cache
+  SHOW_CACHED: 0x02,
+  // Multi-frame sprite, played by the device (see encodeAnimationFrame)
+  ANIMATION: 0x03,
+  // XOR patch against the bitmap the device acknowledged as baseSeq
+  DELTA: 0x04,
+} as const;
+
+export const FrameFlag = {
+  RLE: 0x01,
+  // Animation frames after the first are XOR patches against the previous one
+  XOR: 0x02,
+} as const;
+
+export interface BitmapFrameInput {
+  pokemonId: number;
+  pokemonName: string;
+  width: number;
+  height: number;
+  bitmapData: number[];
+}
+
+/**
+ * PackBits run-length encoding, decoded by apps/device/src/nami/sprite_codec.h
+ *
+ * Control byte n: 0..127 means n + 1 literal bytes follow, 129..255 means
+ * the next byte is repeated 257 - n times.
+ */
+export const encodeRle = (data: Uint8Array): Buffer => {
+  const out: number[] = [];
+  let i = 0;
+
+  while (i < data.length) {
+    // Run of identical bytes (2..128)
+    let run = 1;
+    while (i + run < data.length && run < 128 && data[i + run] === data[i]) {
+      run++;
+    }
+    if (run >= 2) {
+      out.push(257 - run, data[i]);
+      i += run;
+      continue;
+    }
+
+    // Literal bytes, up to the next run of 3 or more (a run of 2 costs as
+    // much as keeping it in the literal)
+    const start = i;
+    while (i < data.length && i - start < 128) {
+      if (
+        i + 2 < data.length &&
+        data[i] === data[i + 1] &&
+        data[i] === data[i + 2]
+      ) {
+        break;
+      }
+      i++;
+    }
+    out.push(i - start - 1);
+    for (let j = start; j < i; j++) {
+      out.push(data[j]);
+    }
+  }
+
+  return Buffer.from(out);
+};
+
+interface FrameHeader {
+  type: number;
+  flags: number;
+  id: number;
+  width: number;
+  height: number;
+  seq: number;
+  baseSeq: number;
+}
+
+// Allocate a frame with its header and name, payloadLength bytes left free
+const allocFrame = (
+  header: FrameHeader,
+  pokemonName: string,
+  payloadLength: number
+): { frame: Buffer; offset: number } => {
+  const name = Buffer.from(pokemonName, "ascii").subarray(0, MAX_NAME_LENGTH);
+  const frame = Buffer.alloc(FRAME_HEADER_SIZE + name.length + payloadLength);
+
+  frame.writeUInt8(FRAME_VERSION, 0);
+  frame.writeUInt8(header.type, 1);
+  frame.writeUInt8(header.flags, 2);
+  frame.writeUInt8(name.length, 3);
+  frame.writeUInt16LE(header.id & 0xffff, 4);
+  frame.writeUInt8(header.width, 6);
+  frame.writeUInt8(header.height, 7);
+  frame.writeUInt16LE(header.seq & 0xffff, 8);
+  frame.writeUInt16LE(header.baseSeq & 0xffff, 10);
+  name.copy(frame, FRAME_HEADER_SIZE);
+
+  return { frame, offset: FRAME_HEADER_SIZE + name.length };
+};
+
+const checkFrameSize = (width: number, height: number) => {
+  if (width <= 0 || width > 255 || height <= 0 || height > 255) {
+    throw new Error(`Bitmap size ${width}x${height} does not fit a frame`);
+  }
+};
+
+// Raw payload, or its PackBits encoding when that is smaller
+const compressPayload = (raw: Buffer): { payload: Buffer; flags: number } => {
+  const compressed = encodeRle(raw);
+  return compressed.length < raw.length
+    ? { payload: compressed, flags: FrameFlag.RLE }
+    : { payload: raw, flags: 0 };
+};
+
+// Byte-wise XOR of two equally sized bitmaps
+export const xorBitmaps = (
+  a: ArrayLike<number>,
+  b: ArrayLike<number>
+): Buffer => {
+  const out = Buffer.alloc(a.length);
+  for (let i = 0; i < a.length; i++) {
+    out[i] = (a[i] ^ (b[i] ?? 0)) & 0xff;
+  }
+  return out;
+};
+
+/**
+ * Encode a Pokemon bitmap as a binary frame for the ESP32
+ * The payload is PackBits compressed whenever that makes it smaller.
+ */
+export const encodeBitmapFrame = (input: BitmapFrameInput, seq = 0): Buffer => {
+  const { pokemonId, pokemonName, width, height, bitmapData } = input;
+  checkFrameSize(width, height);
+
+  const { payload, flags } = compressPayload(Buffer.from(bitmapData));
+  const { frame, offset } = allocFrame(
+    {
+      type: FrameType.BITMAP,
+      flags,
+      id: pokemonId,
+      width,
+      height,
+      seq,
+      baseSeq: 0,
+    },
+    pokemonName,
+    payload.length
+  );
+  payload.copy(frame, offset);
+
+  return frame;
+};
+
+/**
+ * Encode a "show cached sprite" frame (header only, no name or payload)
+ * The device answers with {"type":"sprite_miss","id":N} if it no longer has it.
+ */
+export const encodeShowCachedFrame = (pokemonId: number, seq = 0): Buffer =>
+  allocFrame(
+    {
+      type: FrameType.SHOW_CACHED,
+      flags: 0,
+      id: pokemonId,
+      width: 0,
+      height: 0,
+      seq,
+      baseSeq: 0,
+    },
+    "",
+    0
+  ).frame;
+
+/**
+ * Encode a bitmap as an XOR patch against base, the bitmap the device
+ * acknowledged as baseSeq. Both must have the same size. The name is only
+ * sent (and the header line redrawn) when the Pokemon changes.
+ */
+export const encodeDeltaFrame = (
+  input: BitmapFrameInput,
+  base: BitmapFrameInput,
+  seq: number,
+  baseSeq: number
+): Buffer => {
+  const { pokemonId, pokemonName, width, height, bitmapData } = input;
+  checkFrameSize(width, height);
+  if (base.width !== width || base.height !== height) {
+    throw new Error("Delta base has a different size");
+  }
+
+  const { payload, flags } = compressPayload(
+    xorBitmaps(bitmapData, base.bitmapData)
+  );
+  const name = base.pokemonId === pokemonId ? "" : pokemonName;
+  const { frame, offset } = allocFrame(
+    {
+      type: FrameType.DELTA,
+      flags,
+      id: pokemonId,
+      width,
+      height,
+      seq,
+      baseSeq,
+    },
+    name,
+    payload.length
+  );
+  payload.copy(frame, offset);
+
+  return frame;
+};
+
+export interface AnimationFrameInput {
+  pokemonId: number;
+  pokemonName: string;
+  width: number;
+  height: number;
+  frameDelay: number;
+  frames: number[][];
+}
+
+// Limits of the device's animation slots (apps/device/src/nami/animation_player.h)
+export const ANIMATION_CAPACITY = 12 * 1024;
+export const ANIMATION_MAX_FRAMES = 64;
+export const ANIMATION_MIN_FRAME_DELAY = 33;
+
+/**
+ * Encode an animated sprite as a binary frame for the ESP32
+ *
+ * The payload after the name is:
+ *   0  frameCount  (uint8)
+ *   1  frameDelay  (uint16 ms, little endian)
+ *   3  frameCount x { length (uint16 LE), frame data }
+ * Frames after the first are sent as XOR patches against the previous one
+ * (FrameFlag.XOR) and/or PackBits compressed (FrameFlag.RLE), whichever
+ * combination is smallest. Every other frame is dropped, and the delay
+ * doubled, until the frames fit the device's animation slot.
+ */
+export const encodeAnimationFrame = (input: AnimationFrameInput): Buffer => {
+  const { pokemonId, pokemonName, width, height } = input;
+
+  checkFrameSize(width, height);
+  if (input.frames.length === 0) {
+    throw new Error("Animation has no frames");
+  }
+
+  const total = (list: Buffer[]) =>
+    list.reduce((sum, frame) => sum + frame.length, 0);
+
+  // Smallest encoding of a frame sequence: flags and payloads
+  const encodeFrames = (frames: number[][]) => {
+    const raw = frames.map((frame) => Buffer.from(frame));
+    const patches = raw.map((frame, index) =>
+      index === 0 ? frame : xorBitmaps(frame, raw[index - 1])
+    );
+    const candidates = [
+      { flags: 0, payloads: raw },
+      { flags: FrameFlag.RLE, payloads: raw.map((frame) => encodeRle(frame)) },
+      { flags: FrameFlag.XOR, payloads: patches },
+      {
+        flags: FrameFlag.RLE | FrameFlag.XOR,
+        payloads: patches.map((frame) => encodeRle(frame)),
+      },
+    ];
+    return candidates.reduce((best, candidate) =>
+      total(candidate.payloads) < total(best.payloads) ? candidate : best
+    );
+  };
+
+  let frames = input.frames;
+  let frameDelay = input.frameDelay;
+  let encoded = encodeFrames(frames);
+  while (
+    frames.length > 1 &&
+    (frames.length > ANIMATION_MAX_FRAMES ||
+      total(encoded.payloads) > ANIMATION_CAPACITY)
+  ) {
+    frames = frames.filter((_, index) => index % 2 === 0);
+    frameDelay *= 2;
+    encoded = encodeFrames(frames);
+  }
+  const { flags, payloads } = encoded;
+  if (total(payloads) > ANIMATION_CAPACITY) {
+    throw new Error("Animation frame does not fit the device buffer");
+  }
+  frameDelay = Math.min(
+    Math.max(Math.round(frameDelay), ANIMATION_MIN_FRAME_DELAY),
+    0xffff
+  );
+
+  const { frame, offset: start } = allocFrame(
+    {
+      type: FrameType.ANIMATION,
+      flags,
+      id: pokemonId,
+      width,
+      height,
+      seq: 0,
+      baseSeq: 0,
+    },
+    pokemonName,
+    3 + total(payloads) + 2 * payloads.length
+  );
+
+  let offset = start;
+  frame.writeUInt8(payloads.length, offset);
+  frame.writeUInt16LE(frameDelay, offset + 1);
+  offset += 3;
+  payloads.forEach((payload) => {
+    frame.writeUInt16LE(payload.length, offset);
+    payload.copy(frame, offset + 2);
+    offset += 2 + payload.length;
+  });
+
+  return frame;
+};
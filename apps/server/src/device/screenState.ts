@@ -0,0 +1,44 @@
+import { WebSocket } from "ws";
+import { PokemonBitmap } from "../pokemon/pokemon.js";
+import { sendPokemonSprite } from "./spriteCache.js";
+import { sendTraced } from "./latencyTrace.js";
+
+/**
+ * Last screen sent to the ESP32 clients, for devices that reconnect
+ *
+ * Every display message goes to all ESP32 clients, so there is one current
+ * screen. A device that comes back after a dropped connection lists
+ * "resume":1 in its identify message and gets that screen again, instead
+ * of staying on its "Disconnected" status until the next message.
+ *
+ * Sprites are kept as bitmaps and resent through the sprite cache, so the
+ * device gets a short show-cached frame when it still has them in flash.
+ * Everything else is resent as it was sent.
+ */
+
+type Screen =
+  | { kind: "sprite"; bitmap: PokemonBitmap }
+  | { kind: "message"; data: string | Buffer; binary: boolean };
+
+let currentScreen: Screen | null = null;
+
+export const rememberSprite = (bitmap: PokemonBitmap) => {
+  currentScreen = { kind: "sprite", bitmap };
+};
+
+export const rememberScreen = (data: string | Buffer, binary = false) => {
+  currentScreen = { kind: "message", data, binary };
+};
+
+// Send the current screen to a device that resumed its connection
+// Returns the number of bytes sent
+export const resendScreen = (ws: WebSocket): number => {
+  if (!currentScreen || ws.readyState !== WebSocket.OPEN) {
+    return 0;
+  }
+  if (currentScreen.kind === "sprite") {
+    return sendPokemonSprite(ws, currentScreen.bitmap);
+  }
+  sendTraced(ws, currentScreen.data, currentScreen.binary);
+  return currentScreen.data.length;
+};
@@ -0,0 +1,116 @@
+import { WebSocket } from "ws";
+import { getPokemonBitmap, PokemonBitmap } from "../pokemon/pokemon.js";
+import { getAckedFrame, getSentFrame, nextFrameSeq } from "./frameSync.js";
+import { sendTraced } from "./latencyTrace.js";
+import {
+  encodeBitmapFrame,
+  encodeDeltaFrame,
+  encodeShowCachedFrame,
+} from "./protocol.js";
+
+/**
+ * Server-side view of each ESP32's flash sprite cache
+ *
+ * The device lists its cached ids in the identify message. Every sprite
+ * sent in full is assumed cached from then on. When the device has evicted
+ * a sprite in the meantime, it answers the show-cached frame with a
+ * sprite_miss and gets the full frame instead.
+ */
+
+const deviceSprites = new Map<WebSocket, Set<number>>();
+
+// Record the ids advertised in an identify message
+export const setCachedSprites = (ws: WebSocket, ids: unknown) => {
+  const cached = new Set<number>();
+  if (Array.isArray(ids)) {
+    ids.forEach((id) => {
+      if (Number.isInteger(id)) {
+        cached.add(id);
+      }
+    });
+  }
+  deviceSprites.set(ws, cached);
+  console.log(`🗂️  ESP32 has ${cached.size} cached sprites`);
+};
+
+export const forgetCachedSprites = (ws: WebSocket) => {
+  deviceSprites.delete(ws);
+};
+
+// Send a sprite, as a short reference when the device has it cached, or as
+// an XOR delta against the frame on screen when that is smaller than the
+// full bitmap. Deltas are not cached by the device, so the sprite stays
+// uncached until it is sent in full.
+// Returns the number of bytes sent
+export const sendPokemonSprite = (
+  ws: WebSocket,
+  bitmap: PokemonBitmap
+): number => {
+  let cached = deviceSprites.get(ws);
+  if (!cached) {
+    cached = new Set<number>();
+    deviceSprites.set(ws, cached);
+  }
+
+  const seq = nextFrameSeq(ws, bitmap);
+  let frame: Buffer;
+  let isDelta = false;
+  if (cached.has(bitmap.pokemonId)) {
+    frame = encodeShowCachedFrame(bitmap.pokemonId, seq);
+  } else {
+    frame = encodeBitmapFrame(bitmap, seq);
+    const base = getAckedFrame(ws);
+    if (
+      base &&
+      base.bitmap.width === bitmap.width &&
+      base.bitmap.height === bitmap.height
+    ) {
+      const delta = encodeDeltaFrame(bitmap, base.bitmap, seq, base.seq);
+      if (delta.length < frame.length) {
+        frame = delta;
+        isDelta = true;
+      }
+    }
+  }
+  sendTraced(ws, frame, true);
+  if (!isDelta) {
+    cached.add(bitmap.pokemonId);
+  }
+
+  return frame.length;
+};
+
+// A delta could not be applied (its base was no longer on screen): send
+// that frame's bitmap in full
+export const handleFrameResync = (ws: WebSocket, seq: unknown) => {
+  if (!Number.isInteger(seq)) {
+    return;
+  }
+  const bitmap = getSentFrame(ws, seq as number);
+  if (!bitmap || ws.readyState !== WebSocket.OPEN) {
+    return;
+  }
+  const frame = encodeBitmapFrame(bitmap, nextFrameSeq(ws, bitmap));
+  sendTraced(ws, frame, true);
+  deviceSprites.get(ws)?.add(bitmap.pokemonId);
+  console.log(
+    `[Pokemon] Delta ${seq} rejected, resent #${bitmap.pokemonId} in full (${frame.length} bytes)`
+  );
+};
+
+// The device no longer has this sprite: send it in full
+export const handleSpriteMiss = async (ws: WebSocket, id: unknown) => {
+  if (!Number.isInteger(id)) {
+    return;
+  }
+  const pokemonId = id as number;
+  deviceSprites.get(ws)?.delete(pokemonId);
+
+  const bitmap = await getPokemonBitmap(pokemonId);
+  if (ws.readyState === WebSocket.OPEN) {
+    const bytes = sendPokemonSprite(ws, bitmap);
+    console.log(
+      `[Pokemon] Cache miss for #${pokemonId}, resent full sprite (${bytes} bytes)`
+    );
+  }
+};
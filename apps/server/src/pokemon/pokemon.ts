@@ -127,27 +127,32 @@ const findSmallestSprite = async (
 };
 
 /**
- * Convert PNG image to bitmap format for ESP32 OLED displays
+ * Download an image into a buffer
+ */
+const fetchImage = async (imageUrl: string): Promise<Buffer> => {
+  const imageResponse = await fetch(imageUrl);
+  if (!imageResponse.ok) {
+    throw new Error(`Failed to fetch image: ${imageResponse.statusText}`);
+  }
+  return Buffer.from(await imageResponse.arrayBuffer());
+};
+
+/**
+ * Convert an image (or one page of an animated GIF) to bitmap format for
+ * ESP32 OLED displays
  * Returns 1-bit monochrome bitmap data with dimensions
  */
-const convertToBitmap = async (
-  imageUrl: string
+const imageToBitmap = async (
+  imageBuffer: Buffer,
+  page = 0
 ): Promise<{
   width: number;
   height: number;
   bitmapData: number[];
 }> => {
   try {
-    // Fetch the image
-    const imageResponse = await fetch(imageUrl);
-    if (!imageResponse.ok) {
-      throw new Error(`Failed to fetch image: ${imageResponse.statusText}`);
-    }
-
-    const imageBuffer = Buffer.from(await imageResponse.arrayBuffer());
-
     // Get image metadata to calculate resize dimensions
-    const metadata = await sharp(imageBuffer).metadata();
+    const metadata = await sharp(imageBuffer, { page }).metadata();
     const originalWidth = metadata.width || MAX_WIDTH;
     const originalHeight = metadata.height || MAX_HEIGHT;
 
@@ -181,7 +186,7 @@ const convertToBitmap = async (
 
     // Process image: resize with transparent background
     // First, get the alpha channel BEFORE processing to detect transparent pixels
-    const alphaChannel = await sharp(imageBuffer)
+    const alphaChannel = await sharp(imageBuffer, { page })
       .resize(byteAlignedWidth, height, {
         fit: "contain",
         background: { r: 0, g: 0, b: 0, alpha: 0 }, // Transparent background
@@ -193,7 +198,7 @@ const convertToBitmap = async (
       .toBuffer();
     
     // Process image: resize, convert to grayscale (but don't threshold yet)
-    const processedImage = await sharp(imageBuffer)
+    const processedImage = await sharp(imageBuffer, { page })
       .resize(byteAlignedWidth, height, {
         fit: "contain",
         background: { r: 0, g: 0, b: 0, alpha: 0 }, // Transparent/black background
@@ -241,6 +246,12 @@ const convertToBitmap = async (
   }
 };
 
+/**
+ * Convert PNG image to bitmap format for ESP32 OLED displays
+ */
+const convertToBitmap = async (imageUrl: string) =>
+  imageToBitmap(await fetchImage(imageUrl));
+
 /**
  * Fetch Pokemon details and return the smallest sprite
  */
@@ -274,16 +285,16 @@ export const getPokemonSmallestSprite = async (
 /**
  * Fetch Pokemon details, get default sprite, and convert to bitmap
  */
-export const getPokemonBitmap = async (
-  id: number
-): Promise<{
+export interface PokemonBitmap {
   pokemonId: number;
   pokemonName: string;
   width: number;
   height: number;
   bitmapData: number[];
   originalSpriteUrl: string | null;
-}> => {
+}
+
+const loadPokemonBitmap = async (id: number): Promise<PokemonBitmap> => {
   try {
     const response = await fetch(`${POKEAPI_BASE_URL}/pokemon/${id}`);
 
@@ -314,3 +325,110 @@ export const getPokemonBitmap = async (
     throw new Error(`Failed to get Pokemon bitmap: ${error.message}`);
   }
 };
+
+// Converted bitmaps by Pokemon id; sprites never change, so entries are
+// kept for the lifetime of the server (a few hundred bytes each)
+const bitmapCache = new Map<number, Promise<PokemonBitmap>>();
+
+export const getPokemonBitmap = (id: number): Promise<PokemonBitmap> => {
+  let bitmap = bitmapCache.get(id);
+  if (!bitmap) {
+    bitmap = loadPokemonBitmap(id);
+    bitmapCache.set(id, bitmap);
+    // Don't remember failures, the next request retries
+    bitmap.catch(() => bitmapCache.delete(id));
+  }
+  return bitmap;
+};
+
+/**
+ * Animated sprite: every frame has the same size, frameDelay is in ms
+ */
+export interface PokemonAnimation {
+  pokemonId: number;
+  pokemonName: string;
+  width: number;
+  height: number;
+  frameDelay: number;
+  frames: number[][];
+  originalSpriteUrl: string;
+}
+
+// The device never keeps more frames than this (ANIMATION_MAX_FRAMES)
+const MAX_ANIMATION_FRAMES = 64;
+const DEFAULT_FRAME_DELAY_MS = 100;
+
+const findAnimatedSprite = (sprites: PokemonSprites): string | null => {
+  const blackWhite = (sprites.versions as any)?.["generation-v"]?.[
+    "black-white"
+  ];
+  return (
+    sprites.other?.showdown?.front_default ||
+    blackWhite?.animated?.front_default ||
+    null
+  );
+};
+
+const loadPokemonAnimation = async (id: number): Promise<PokemonAnimation> => {
+  try {
+    const response = await fetch(`${POKEAPI_BASE_URL}/pokemon/${id}`);
+
+    if (!response.ok) {
+      throw new Error(`Failed to fetch Pokemon: ${response.statusText}`);
+    }
+
+    const pokemon: PokemonResponse = (await response.json()) as PokemonResponse;
+    const spriteUrl = findAnimatedSprite(pokemon.sprites);
+
+    if (!spriteUrl) {
+      throw new Error("No animated sprite found for this Pokemon");
+    }
+
+    const imageBuffer = await fetchImage(spriteUrl);
+    const metadata = await sharp(imageBuffer).metadata();
+    const pages = metadata.pages || 1;
+    const delays = metadata.delay || [];
+
+    // Long animations are subsampled down to what the device can hold
+    const step = Math.ceil(pages / MAX_ANIMATION_FRAMES);
+    const frames: number[][] = [];
+    let width = 0;
+    let height = 0;
+    for (let page = 0; page < pages; page += step) {
+      const bitmap = await imageToBitmap(imageBuffer, page);
+      width = bitmap.width;
+      height = bitmap.height;
+      frames.push(bitmap.bitmapData);
+    }
+
+    const averageDelay = delays.length
+      ? delays.reduce((sum, delay) => sum + delay, 0) / delays.length
+      : DEFAULT_FRAME_DELAY_MS;
+
+    return {
+      pokemonId: pokemon.id,
+      pokemonName: pokemon.name,
+      width,
+      height,
+      frameDelay: Math.round((averageDelay || DEFAULT_FRAME_DELAY_MS) * step),
+      frames,
+      originalSpriteUrl: spriteUrl,
+    };
+  } catch (error: any) {
+    throw new Error(`Failed to get Pokemon animation: ${error.message}`);
+  }
+};
+
+// Converted animations by Pokemon id, kept like bitmapCache
+const animationCache = new Map<number, Promise<PokemonAnimation>>();
+
+export const getPokemonAnimation = (id: number): Promise<PokemonAnimation> => {
+  let animation = animationCache.get(id);
+  if (!animation) {
+    animation = loadPokemonAnimation(id);
+    animationCache.set(id, animation);
+    // Don't remember failures, the next request retries
+    animation.catch(() => animationCache.delete(id));
+  }
+  return animation;
+};
@@ -13,6 +13,37 @@ import { WebSocket, WebSocketServer } from "ws";
 import packageJson from "../package.json" assert { type: "json" };
 import { getMessages, sendMessage } from "./chat/chat.js";
 import {
+  encodeInfoProfile,
+  getDeviceInfo,
+  subscribeInfo,
+  unsubscribeInfo,
+} from "./device/infoStream.js";
+import {
+  forgetFrameState,
+  handleFrameAck,
+} from "./device/frameSync.js";
+import {
+  forgetTrace,
+  getLatencyStats,
+  handleTraceAck,
+  sendTraced,
+  startTracing,
+} from "./device/latencyTrace.js";
+import { encodeAnimationFrame } from "./device/protocol.js";
+import {
+  rememberScreen,
+  rememberSprite,
+  resendScreen,
+} from "./device/screenState.js";
+import {
+  forgetCachedSprites,
+  handleFrameResync,
+  handleSpriteMiss,
+  sendPokemonSprite,
+  setCachedSprites,
+} from "./device/spriteCache.js";
+import {
+  getPokemonAnimation,
   getPokemonBitmap,
   getPokemonSmallestSprite,
 } from "./pokemon/pokemon.js";
@@ -120,6 +151,13 @@ app.get("/", (req, res) => {
 
 app.get("/info", async (req, res) => {
   try {
+    // Compact fixed-size record for the ESP32, independent of the host's
+    // network configuration
+    if (req.query.profile === "nami") {
+      res.type("application/octet-stream");
+      return res.send(encodeInfoProfile(getDeviceInfo()));
+    }
+
     const info = await getRaspberryPiInfo();
     res.json(info);
   } catch (error) {
@@ -127,6 +165,11 @@ app.get("/info", async (req, res) => {
   }
 });
 
+// Send-to-pixels latency per ESP32 (p50/p95/p99 in ms, see latencyTrace.ts)
+app.get("/api/devices/latency", (req, res) => {
+  res.json({ devices: getLatencyStats() });
+});
+
 // Chat API endpoints
 app.post("/api/chat/messages", async (req, res) => {
   try {
@@ -211,30 +254,22 @@ app.post("/api/pokemon/bitmap", async (req, res) => {
     }
 
     const result = await getPokemonBitmap(id);
+    rememberSprite(result);
 
-    // Send bitmap data to all connected ESP32 clients via WebSocket
-    const pokemonMessage = JSON.stringify({
-      type: "pokemon_bitmap",
-      data: {
-        pokemonId: result.pokemonId,
-        pokemonName: result.pokemonName,
-        width: result.width,
-        height: result.height,
-        bitmapData: result.bitmapData,
-      },
-    });
-
+    // Send the sprite to all connected ESP32 clients, as a short
+    // reference when the device already has it in its flash cache
     let sentToEsp32 = false;
+    let bytesSent = 0;
     esp32Clients.forEach((esp32Client) => {
       if (esp32Client.readyState === WebSocket.OPEN) {
-        esp32Client.send(pokemonMessage);
+        bytesSent += sendPokemonSprite(esp32Client, result);
         sentToEsp32 = true;
       }
     });
 
     if (sentToEsp32) {
       console.log(
-        `[Pokemon] Sent bitmap for Pokemon #${result.pokemonId} (${result.pokemonName}) to ESP32 clients`
+        `[Pokemon] Sent bitmap for Pokemon #${result.pokemonId} (${result.pokemonName}) to ESP32 clients (${bytesSent} bytes)`
       );
     }
 
@@ -253,6 +288,60 @@ app.post("/api/pokemon/bitmap", async (req, res) => {
   }
 });
 
+// Pokemon animation API endpoint
+app.post("/api/pokemon/animation", async (req, res) => {
+  try {
+    const { id } = req.body;
+
+    if (!id || typeof id !== "number") {
+      return res.status(400).json({
+        success: false,
+        error: "Pokemon ID is required and must be a number",
+      });
+    }
+
+    const result = await getPokemonAnimation(id);
+    const frame = encodeAnimationFrame(result);
+    rememberScreen(frame, true);
+
+    // Send the animation to all connected ESP32 clients
+    let sentToEsp32 = false;
+    esp32Clients.forEach((esp32Client) => {
+      if (esp32Client.readyState === WebSocket.OPEN) {
+        sendTraced(esp32Client, frame, true);
+        sentToEsp32 = true;
+      }
+    });
+
+    if (sentToEsp32) {
+      console.log(
+        `[Pokemon] Sent animation for Pokemon #${result.pokemonId} (${result.pokemonName}, ${result.frames.length} frames) to ESP32 clients (${frame.length} bytes)`
+      );
+    }
+
+    res.json({
+      success: true,
+      data: {
+        pokemonId: result.pokemonId,
+        pokemonName: result.pokemonName,
+        width: result.width,
+        height: result.height,
+        frameDelay: result.frameDelay,
+        frameCount: result.frames.length,
+        originalSpriteUrl: result.originalSpriteUrl,
+      },
+      sentToEsp32,
+    });
+  } catch (error: any) {
+    console.error("Error getting Pokemon animation:", error);
+    res.status(500).json({
+      success: false,
+      error: "Failed to get Pokemon animation",
+      message: error.message || "Unknown error",
+    });
+  }
+});
+
 // ASCII Art API endpoint
 app.post("/api/ascii-art", async (req, res) => {
   try {
@@ -282,12 +371,13 @@ app.post("/api/ascii-art", async (req, res) => {
 
     const asciiArt =
       completion.choices[0]?.message?.content || "No ASCII art generated";
+    rememberScreen(asciiArt);
 
     // Send ASCII art to all connected ESP32 clients via WebSocket
     let sent = false;
     esp32Clients.forEach((esp32Client) => {
       if (esp32Client.readyState === WebSocket.OPEN) {
-        esp32Client.send(asciiArt);
+        sendTraced(esp32Client, asciiArt);
         sent = true;
       }
     });
@@ -320,6 +410,16 @@ const wss = new WebSocketServer({ server });
 const webClients = new Set<WebSocket>();
 const esp32Clients = new Set<WebSocket>();
 
+// Push the latency stats to all web clients
+const broadcastLatency = () => {
+  const message = JSON.stringify({ type: "latency", devices: getLatencyStats() });
+  webClients.forEach((webClient) => {
+    if (webClient.readyState === WebSocket.OPEN) {
+      webClient.send(message);
+    }
+  });
+};
+
 wss.on("connection", (ws: WebSocket, req) => {
   console.log("🔌 WebSocket client connected");
 
@@ -364,10 +464,63 @@ wss.on("connection", (ws: WebSocket, req) => {
         webClients.delete(ws);
         esp32Clients.add(ws);
         (ws as any).clientType = "esp32";
+        setCachedSprites(ws, parsed.cached);
+        startTracing(
+          ws,
+          `${req.socket.remoteAddress}:${req.socket.remotePort}`,
+          parsed.trace
+        );
         console.log(
           "📱 Client identified as ESP32. Total ESP32 clients:",
           esp32Clients.size
         );
+        // A device back from a dropped connection gets the current screen again
+        if (parsed.resume === 1) {
+          const bytes = resendScreen(ws);
+          console.log(`🔁 ESP32 resumed, resent current screen (${bytes} bytes)`);
+        }
+        return;
+      }
+      // Device-only messages; from a web client they are forwarded like any other
+      const fromDevice = (ws as any).clientType === "esp32";
+      if (fromDevice && parsed.type === "sprite_miss") {
+        handleSpriteMiss(ws, parsed.id).catch((error) => {
+          console.error("Error resending Pokemon sprite:", error);
+        });
+        return;
+      }
+      if (fromDevice && parsed.type === "frame_ack") {
+        handleFrameAck(ws, parsed.seq);
+        return;
+      }
+      if (fromDevice && parsed.type === "trace_ack") {
+        if (handleTraceAck(ws, parsed)) {
+          broadcastLatency();
+        }
+        return;
+      }
+      if (fromDevice && parsed.type === "frame_resync") {
+        handleFrameResync(ws, parsed.seq);
+        return;
+      }
+      if (fromDevice && parsed.type === "subscribe" && parsed.topic === "info") {
+        subscribeInfo(ws);
+        return;
+      }
+      if (fromDevice && parsed.type === "log") {
+        // Device warnings and errors, forwarded by its log task
+        console.log(`📟 ESP32 ${parsed.level} @${parsed.ms} ms: ${parsed.text}`);
+        const message = JSON.stringify({
+          type: "device_log",
+          level: parsed.level,
+          ms: parsed.ms,
+          text: parsed.text,
+        });
+        webClients.forEach((webClient) => {
+          if (webClient.readyState === WebSocket.OPEN) {
+            webClient.send(message);
+          }
+        });
         return;
       }
     } catch (e) {
@@ -377,10 +530,11 @@ wss.on("connection", (ws: WebSocket, req) => {
     // If message is from a web client, forward to all ESP32 clients
     if (webClients.has(ws) || (ws as any).clientType === "web") {
       console.log("📤 Forwarding message to ESP32 clients...");
+      rememberScreen(messageStr);
       let forwarded = false;
       esp32Clients.forEach((esp32Client) => {
         if (esp32Client.readyState === WebSocket.OPEN) {
-          esp32Client.send(messageStr);
+          sendTraced(esp32Client, messageStr);
           forwarded = true;
         }
       });
@@ -421,6 +575,10 @@ wss.on("connection", (ws: WebSocket, req) => {
   });
 
   ws.on("close", () => {
+    unsubscribeInfo(ws);
+    forgetCachedSprites(ws);
+    forgetFrameState(ws);
+    forgetTrace(ws);
     if (webClients.has(ws)) {
       webClients.delete(ws);
       console.log(
@@ -439,6 +597,10 @@ wss.on("connection", (ws: WebSocket, req) => {
   ws.on("error", (error: Error) => {
     console.error("❌ WebSocket error:", error);
     // Clean up on error
+    unsubscribeInfo(ws);
+    forgetCachedSprites(ws);
+    forgetFrameState(ws);
+    forgetTrace(ws);
     webClients.delete(ws);
     esp32Clients.delete(ws);
   });
@@ -0,0 +1,260 @@
+import http from "http";
+import { WebSocket, WebSocketServer } from "ws";
+import {
+  forgetFrameState,
+  getAckedFrame,
+  handleFrameAck,
+  nextFrameSeq,
+} from "../device/frameSync.js";
+import {
+  encodeInfoProfile,
+  getDeviceInfo,
+  subscribeInfo,
+  unsubscribeInfo,
+} from "../device/infoStream.js";
+import {
+  forgetTrace,
+  getLatencyStats,
+  handleTraceAck,
+  sendTraced,
+  startTracing,
+} from "../device/latencyTrace.js";
+import {
+  BitmapFrameInput,
+  encodeAnimationFrame,
+  encodeBitmapFrame,
+  encodeDeltaFrame,
+} from "../device/protocol.js";
+
+/**
+ * Stub server for the host simulation of the firmware (apps/device/sim)
+ *
+ * Speaks the same protocol as server.ts, using the same encoders, but
+ * needs no network access, OpenAI key or sprite downloads: it plays a fixed
+ * script of texts, procedurally drawn sprites, deltas and an animation to
+ * every device that connects, one scene every SCENE_INTERVAL_MS. Display
+ * messages are traced like on the real server (GET /api/devices/latency).
+ * A device that reconnects with "resume":1 gets the last scene played
+ * again, then the script continues from there.
+ *
+ *   bun run sim                      (PORT and SCENE_INTERVAL_MS optional)
+ */
+
+const PORT = process.env.PORT ? parseInt(process.env.PORT, 10) : 3000;
+const SCENE_INTERVAL_MS = process.env.SCENE_INTERVAL_MS
+  ? parseInt(process.env.SCENE_INTERVAL_MS, 10)
+  : 4000;
+
+const SPRITE_SIZE = 40;
+const SPRITE_ID = 9001;
+const SPRITE_NAME = "stubby";
+
+// 1bpp row-major, MSB first, lit where inside(x, y) is true
+const drawBitmap = (
+  width: number,
+  height: number,
+  inside: (x: number, y: number) => boolean
+): number[] => {
+  const stride = Math.ceil(width / 8);
+  const data = new Array<number>(stride * height).fill(0);
+  for (let y = 0; y < height; y++) {
+    for (let x = 0; x < width; x++) {
+      if (inside(x, y)) {
+        data[y * stride + (x >> 3)] |= 0x80 >> (x & 7);
+      }
+    }
+  }
+  return data;
+};
+
+// A round face whose eyes look in the direction of angle
+const drawFace = (angle: number): BitmapFrameInput => {
+  const center = SPRITE_SIZE / 2;
+  const eyeX = Math.cos(angle) * 3;
+  const eyeY = Math.sin(angle) * 3;
+  const bitmapData = drawBitmap(SPRITE_SIZE, SPRITE_SIZE, (x, y) => {
+    const d = Math.hypot(x - center, y - center);
+    const leftEye = Math.hypot(x - (center - 7 + eyeX), y - (center - 4 + eyeY));
+    const rightEye = Math.hypot(x - (center + 7 + eyeX), y - (center - 4 + eyeY));
+    return (d > 16 && d <= 18) || leftEye <= 2.5 || rightEye <= 2.5;
+  });
+  return {
+    pokemonId: SPRITE_ID,
+    pokemonName: SPRITE_NAME,
+    width: SPRITE_SIZE,
+    height: SPRITE_SIZE,
+    bitmapData,
+  };
+};
+
+// A ball bouncing across the sprite box
+const drawBounce = () => {
+  const frames: number[][] = [];
+  for (let i = 0; i < 16; i++) {
+    const t = i / 16;
+    const cx = 6 + t * (SPRITE_SIZE - 12);
+    const cy = SPRITE_SIZE - 6 - Math.abs(Math.sin(t * Math.PI * 2)) * 26;
+    frames.push(
+      drawBitmap(SPRITE_SIZE, SPRITE_SIZE, (x, y) =>
+        Math.hypot(x - cx, y - cy) <= 5 || y === SPRITE_SIZE - 1
+      )
+    );
+  }
+  return {
+    pokemonId: SPRITE_ID + 1,
+    pokemonName: "bounce",
+    width: SPRITE_SIZE,
+    height: SPRITE_SIZE,
+    frameDelay: 60,
+    frames,
+  };
+};
+
+const ASCII_ART = [
+  "   /\\_/\\",
+  "  ( o.o )",
+  "   > ^ <",
+  "  /     \\",
+  " (       )",
+  "  \\__ __/",
+  "    | |",
+  "   _| |_",
+  "  |_____|",
+  "  stub server",
+  "  scrolling test",
+  "  line twelve",
+].join("\n");
+
+// Sends a face as a delta against the acknowledged one, or in full
+const sendFace = (ws: WebSocket, face: BitmapFrameInput) => {
+  const base = getAckedFrame(ws);
+  const seq = nextFrameSeq(ws, face);
+  const frame =
+    base &&
+    base.bitmap.width === face.width &&
+    base.bitmap.height === face.height
+      ? encodeDeltaFrame(face, base.bitmap, seq, base.seq)
+      : encodeBitmapFrame(face, seq);
+  sendTraced(ws, frame, true);
+  return frame.length;
+};
+
+type Scene = (ws: WebSocket, step: number) => string;
+
+const scenes: Scene[] = [
+  (ws) => {
+    sendTraced(ws, "Hello from the stub server");
+    return "short text";
+  },
+  (ws) => {
+    sendTraced(ws, ASCII_ART);
+    return "ASCII art";
+  },
+  (ws, step) => {
+    const bytes = sendFace(ws, drawFace(step));
+    return `face (${bytes} bytes)`;
+  },
+  (ws, step) => {
+    const bytes = sendFace(ws, drawFace(step + Math.PI));
+    return `face again (${bytes} bytes)`;
+  },
+  (ws) => {
+    const frame = encodeAnimationFrame(drawBounce());
+    sendTraced(ws, frame, true);
+    return `animation (${frame.length} bytes)`;
+  },
+];
+
+const server = http.createServer((req, res) => {
+  if (req.url?.startsWith("/info")) {
+    res.writeHead(200, { "Content-Type": "application/octet-stream" });
+    res.end(encodeInfoProfile(getDeviceInfo()));
+    return;
+  }
+  if (req.url === "/api/devices/latency") {
+    res.writeHead(200, { "Content-Type": "application/json" });
+    res.end(JSON.stringify({ devices: getLatencyStats() }));
+    return;
+  }
+  res.writeHead(404);
+  res.end();
+});
+
+const wss = new WebSocketServer({ server });
+
+// Last scene played to any device, replayed on resume
+let lastStep: number | null = null;
+
+wss.on("connection", (ws: WebSocket, req) => {
+  console.log("🔌 Simulated device connected");
+  let step = 0;
+
+  const playScene = () => {
+    const scene = scenes[step % scenes.length];
+    console.log(`🎬 Scene ${step}: ${scene(ws, step)}`);
+    lastStep = step;
+    step++;
+  };
+
+  const timer = setInterval(() => {
+    if (ws.readyState !== WebSocket.OPEN) {
+      return;
+    }
+    playScene();
+  }, SCENE_INTERVAL_MS);
+
+  ws.on("message", (message: Buffer) => {
+    const messageStr = message.toString();
+    try {
+      const parsed = JSON.parse(messageStr);
+      if (parsed.type === "identify") {
+        startTracing(
+          ws,
+          `${req.socket.remoteAddress}:${req.socket.remotePort}`,
+          parsed.trace
+        );
+        if (parsed.resume === 1 && lastStep !== null) {
+          console.log(`🔁 Device resumed, replaying scene ${lastStep}`);
+          step = lastStep;
+          playScene();
+        }
+      }
+      if (parsed.type === "frame_ack") {
+        handleFrameAck(ws, parsed.seq);
+        return;
+      }
+      if (parsed.type === "trace_ack") {
+        if (handleTraceAck(ws, parsed)) {
+          const [stats] = getLatencyStats().filter((d) => d.samples > 0);
+          if (stats) {
+            console.log(`⏱️  Send to pixels p50/p95/p99: ${JSON.stringify(stats.stages.total)} ms`);
+          }
+        }
+        return;
+      }
+      if (parsed.type === "subscribe" && parsed.topic === "info") {
+        subscribeInfo(ws);
+        return;
+      }
+      if (parsed.type === "log") {
+        console.log(`📟 Device ${parsed.level} @${parsed.ms} ms: ${parsed.text}`);
+        return;
+      }
+    } catch (e) {
+      // Not JSON, just log it
+    }
+    console.log("📨 Received message:", messageStr);
+  });
+
+  ws.on("close", () => {
+    clearInterval(timer);
+    unsubscribeInfo(ws);
+    forgetFrameState(ws);
+    forgetTrace(ws);
+    console.log("🔌 Simulated device disconnected");
+  });
+});
+
+server.listen(PORT, () => {
+  console.log(`🧪 Stub server listening on port ${PORT}`);
+});